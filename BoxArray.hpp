@@ -2,111 +2,181 @@
 #define BOXARRAY_HPP
 
 #include <stddef.h>
+#include <algorithm>
+#include <initializer_list>
 #include <iterator>
 #include <stdexcept>
 
 namespace _2Ls
 {
-    template <typename T>
-    class BoxArray
+    // Storage shared by the fixed-capacity Box containers. Nothing is virtual: members whose
+    // meaning depends on the container (begin, size, ...) are reached through Derived, and the
+    // capacity checks of push, pop, extract, front and back compile out when checked is false.
+    template <typename T, typename Derived, bool checked>
+    class BoxArrayBase
     {
     protected:
         size_t _max_size;
         T *_data;
         size_t _end = 0;
+        bool _owner;
 
     public:
-        BoxArray(const size_t &size = 0, T data[] = nullptr) noexcept
-            : _max_size(size), _data(data ? data : new T[size]) {} // Parameterized constructor
-        BoxArray(std::initializer_list<T> init)
-            : _data(new T[init.size()]),
-              _max_size(init.size()),
-              _end(init.size()) { std::copy(init.begin(), init.end(), _data.get()); } // Initializer-List constructor
-        BoxArray(const BoxArray &) noexcept = default;                                // Copy constructor
-        BoxArray(BoxArray &&) noexcept = default;                                     // Move constructor
-        BoxArray &operator=(const BoxArray &) noexcept = default;                     // Copy assignment
-        BoxArray &operator=(BoxArray &&) noexcept = default;                          // Move assignment
-        virtual ~BoxArray() { delete[] _data; }                                       // Default destructor
+        BoxArrayBase(const size_t &size = 0, T data[] = nullptr)
+            : _max_size(size), _data(data ? data : (size ? new T[size] : nullptr)),
+              _owner(data == nullptr) {} // Parameterized constructor
+        BoxArrayBase(std::initializer_list<T> init)
+            : _max_size(init.size()),
+              _data(new T[init.size()]),
+              _end(init.size()),
+              _owner(true) { std::copy(init.begin(), init.end(), _data); } // Initializer-List constructor
+        BoxArrayBase(const BoxArrayBase &other)
+            : _max_size(other._max_size), _data(other._max_size ? new T[other._max_size] : nullptr),
+              _end(other._end), _owner(true)
+        {
+            std::copy(other._data, other._data + other._max_size, _data);
+        } // Copy constructor
+        BoxArrayBase(BoxArrayBase &&other) noexcept
+            : _max_size(other._max_size), _data(other._data), _end(other._end), _owner(other._owner)
+        {
+            other._max_size = 0, other._data = nullptr, other._end = 0, other._owner = true;
+        } // Move constructor
+        BoxArrayBase &operator=(const BoxArrayBase &other)
+        {
+            if (this != &other)
+            {
+                BoxArrayBase temp(other);
+                swap(temp);
+            }
+            return *this;
+        } // Copy assignment
+        BoxArrayBase &operator=(BoxArrayBase &&other) noexcept
+        {
+            swap(other);
+            return *this;
+        }                                                     // Move assignment
+        ~BoxArrayBase() noexcept { release(); }               // Default destructor
+
+        T *begin() noexcept { return _data; }
+        const T *begin() const noexcept { return _data; }
+        T *end() noexcept { return _data + _end; }
+        const T *end() const noexcept { return _data + _end; }
+        std::reverse_iterator<T *> rbegin() noexcept { return std::reverse_iterator<T *>(self().end()); }
+        std::reverse_iterator<const T *> rbegin() const noexcept { return std::reverse_iterator<const T *>(self().end()); }
+        std::reverse_iterator<T *> rend() noexcept { return std::reverse_iterator<T *>(self().begin()); }
+        std::reverse_iterator<const T *> rend() const noexcept { return std::reverse_iterator<const T *>(self().begin()); }
+        const T *cbegin() const noexcept { return self().begin(); }
+        const T *cend() const noexcept { return self().end(); }
+        std::reverse_iterator<const T *> crbegin() const noexcept { return self().rbegin(); }
+        std::reverse_iterator<const T *> crend() const noexcept { return self().rend(); }
 
-        virtual T *begin() noexcept { return _data; }
-        virtual const T *begin() const noexcept { return _data; }
-        virtual T *end() noexcept { return _data + _end; }
-        virtual const T *end() const noexcept { return _data + _end; }
-        virtual std::reverse_iterator<T *> rbegin() noexcept { return std::reverse_iterator<T *>(end()); }
-        virtual std::reverse_iterator<const T *> rbegin() const noexcept { return std::reverse_iterator<const T *>(end()); }
-        virtual std::reverse_iterator<T *> rend() noexcept { return std::reverse_iterator<T *>(begin()); }
-        virtual std::reverse_iterator<const T *> rend() const noexcept { return std::reverse_iterator<const T *>(begin()); }
-        virtual const T *cbegin() const noexcept { return begin(); }
-        virtual const T *cend() const noexcept { return end(); }
-        virtual std::reverse_iterator<const T *> crbegin() const noexcept { return rbegin(); }
-        virtual std::reverse_iterator<const T *> crend() const noexcept { return rend(); }
+        size_t size() const noexcept { return _end; }
+        size_t max_size() const noexcept { return _max_size; }
+        bool empty() const noexcept { return self().size() == 0; }
+        bool full() const noexcept { return self().size() == _max_size; }
 
-        virtual size_t size() const noexcept { return _end; }
-        virtual size_t max_end() const noexcept { return _max_size; }
-        virtual bool empty() const noexcept { return _end == 0; }
-        virtual bool full() const noexcept { return _end == _max_size; }
+        T &operator[](const size_t &index) noexcept { return _data[index]; }
+        const T &operator[](const size_t &index) const noexcept { return _data[index]; }
+        T *data() noexcept { return _data; }
+        const T *data() const noexcept { return _data; }
+
+        void clear() noexcept { _end = 0; }
+
+    protected:
+        Derived &self() noexcept { return static_cast<Derived &>(*this); }
+        const Derived &self() const noexcept { return static_cast<const Derived &>(*this); }
+        void swap(BoxArrayBase &other) noexcept
+        {
+            std::swap(_max_size, other._max_size);
+            std::swap(_data, other._data);
+            std::swap(_end, other._end);
+            std::swap(_owner, other._owner);
+        }
+        void release() noexcept
+        {
+            if (_owner)
+                delete[] _data;
+            _data = nullptr;
+        }
+    };
+
+    template <typename T, bool checked = true>
+    class BoxArray : public BoxArrayBase<T, BoxArray<T, checked>, checked>
+    {
+        using Base = BoxArrayBase<T, BoxArray<T, checked>, checked>;
+
+    public:
+        BoxArray(const size_t &size = 0, T data[] = nullptr) : Base(size, data) {} // Parameterized constructor
+        BoxArray(std::initializer_list<T> init) : Base(init) {}                    // Initializer-List constructor
+        BoxArray(const BoxArray &) = default;                                      // Copy constructor
+        BoxArray(BoxArray &&) noexcept = default;                                  // Move constructor
+        BoxArray &operator=(const BoxArray &) = default;                           // Copy assignment
+        BoxArray &operator=(BoxArray &&) noexcept = default;                       // Move assignment
+        ~BoxArray() noexcept = default;                                            // Default destructor
 
-        virtual T &operator[](const size_t &index) noexcept { return _data[index]; }
-        virtual const T &operator[](const size_t &index) const noexcept { return _data[index]; }
-        virtual T &at(const size_t &index)
+        T &at(const size_t &index)
         {
-            if (index >= _end)
+            if (index >= this->_end)
                 throw std::out_of_range("_2Ls::BoxArray::at out of range");
-            return _data[index];
+            return this->_data[index];
         }
-        virtual const T &at(const size_t &index) const
+        const T &at(const size_t &index) const
         {
-            if (index >= _end)
+            if (index >= this->_end)
                 throw std::out_of_range("_2Ls::BoxArray::at out of range");
-            return _data[index];
+            return this->_data[index];
         }
-        virtual T &front()
+        T &front() noexcept(!checked)
         {
-            if (_end == 0)
-                throw std::underflow_error("_2Ls::BoxArray::front underflow");
-            return _data[0];
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxArray::front underflow");
+            return this->_data[0];
         }
-        virtual const T &front() const
+        const T &front() const noexcept(!checked)
         {
-            if (_end == 0)
-                throw std::underflow_error("_2Ls::BoxArray::front underflow");
-            return _data[0];
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxArray::front underflow");
+            return this->_data[0];
         }
-        virtual T &back()
+        T &back() noexcept(!checked)
         {
-            if (_end == 0)
-                throw std::underflow_error("_2Ls::BoxArray::back underflow");
-            return _data[_end - 1];
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxArray::back underflow");
+            return this->_data[this->_end - 1];
         }
-        virtual const T &back() const
+        const T &back() const noexcept(!checked)
         {
-            if (_end == 0)
-                throw std::underflow_error("_2Ls::BoxArray::back underflow");
-            return _data[_end - 1];
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxArray::back underflow");
+            return this->_data[this->_end - 1];
         }
-        virtual T *data() noexcept { return _data; }
-        virtual const T *data() const noexcept { return _data; }
 
-        virtual void push(const T &value)
+        void push(const T &value) noexcept(!checked)
         {
-            if (_end == _max_size)
-                throw std::overflow_error("_2Ls::BoxArray::push overflow");
-            _data[_end++] = value;
+            if constexpr (checked)
+                if (this->_end == this->_max_size)
+                    throw std::overflow_error("_2Ls::BoxArray::push overflow");
+            this->_data[this->_end++] = value;
         }
-        virtual void pop()
+        void pop() noexcept(!checked)
         {
-            if (_end == 0)
-                throw std::underflow_error("_2Ls::BoxArray::pop underflow");
-            --_end;
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxArray::pop underflow");
+            --this->_end;
         }
 
-        virtual T extract()
+        T extract() noexcept(!checked)
         {
-            if (_end == 0)
-                throw std::underflow_error("_2Ls::BoxArray::extract underflow");
-            return _data[--_end];
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxArray::extract underflow");
+            return this->_data[--this->_end];
         }
-        virtual void clear() noexcept { _end = 0; }
     };
 }
 
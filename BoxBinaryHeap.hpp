@@ -1,82 +1,98 @@
 #ifndef BOXBINARYHEAP_HPP
 #define BOXBINARYHEAP_HPP
-#include <iostream>
+
+#include <cstdint>
+#include <functional>
 #include "BoxArray.hpp"
 
 namespace _2Ls
 {
-    template <typename T, typename Comparator = std::less<T>>
-    class BoxBinaryHeap : public BoxArray<T>
+    // front() is the element that compares before every other one, so std::less gives a min-heap
+    template <typename T, typename Comparator = std::less<T>, bool checked = true>
+    class BoxBinaryHeap : public BoxArrayBase<T, BoxBinaryHeap<T, Comparator, checked>, checked>
     {
+        using Base = BoxArrayBase<T, BoxBinaryHeap<T, Comparator, checked>, checked>;
+
     protected:
         Comparator _cmp;
 
     public:
         BoxBinaryHeap(const size_t &size = 0, T data[] = nullptr)
-            : BoxArray<T>(size, data), _cmp(Comparator()) {}                // Parameterized constructor
-        BoxBinaryHeap(std::initializer_list<T> init) : BoxArray<T>(init) {} // Initializer-List constructor
-        BoxBinaryHeap(const BoxBinaryHeap &) noexcept = default;            // Copy constructor
-        BoxBinaryHeap(BoxBinaryHeap &&) noexcept = default;                 // Move constructor
-        BoxBinaryHeap &operator=(const BoxBinaryHeap &) noexcept = default; // Copy assignment
-        BoxBinaryHeap &operator=(BoxBinaryHeap &&) noexcept = default;      // Move assignment
-        ~BoxBinaryHeap() noexcept = default;                                // Default destructor
+            : Base(size, data), _cmp(Comparator()) {} // Parameterized constructor
+        BoxBinaryHeap(std::initializer_list<T> init) : Base(init), _cmp(Comparator())
+        {
+            for (size_t i = this->_end / 2; i-- != 0;)
+                heapify_down(i);
+        }                                                             // Initializer-List constructor
+        BoxBinaryHeap(const BoxBinaryHeap &) = default;               // Copy constructor
+        BoxBinaryHeap(BoxBinaryHeap &&) noexcept = default;           // Move constructor
+        BoxBinaryHeap &operator=(const BoxBinaryHeap &) = default;    // Copy assignment
+        BoxBinaryHeap &operator=(BoxBinaryHeap &&) noexcept = default; // Move assignment
+        ~BoxBinaryHeap() noexcept = default;                          // Default destructor
 
-        T &at(const size_t &index) override
+        T &at(const size_t &index)
         {
             if (index >= this->_end)
                 throw std::out_of_range("_2Ls::BoxBinaryHeap::at out of range");
             return this->_data[index];
         }
-        const T &at(const size_t &index) const override
+        const T &at(const size_t &index) const
         {
             if (index >= this->_end)
                 throw std::out_of_range("_2Ls::BoxBinaryHeap::at out of range");
             return this->_data[index];
         }
-        T &front() override
+        T &front() noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxBinaryHeap::front underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxBinaryHeap::front underflow");
             return this->_data[0];
         }
-        const T &front() const override
+        const T &front() const noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxBinaryHeap::front underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxBinaryHeap::front underflow");
             return this->_data[0];
         }
-        T &back() override
+        T &back() noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxBinaryHeap::back underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxBinaryHeap::back underflow");
             return this->_data[this->_end - 1];
         }
-        const T &back() const override
+        const T &back() const noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxBinaryHeap::back underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxBinaryHeap::back underflow");
             return this->_data[this->_end - 1];
         }
 
-        void push(const T &value) override
+        void push(const T &value) noexcept(!checked)
         {
-            if (this->_end == this->_max_size)
-                throw std::overflow_error("_2Ls::BoxBinaryHeap::push overflow");
+            if constexpr (checked)
+                if (this->_end == this->_max_size)
+                    throw std::overflow_error("_2Ls::BoxBinaryHeap::push overflow");
             this->_data[this->_end] = value;
             heapify_up(this->_end++);
         }
-        void pop() override
+        void pop() noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxBinaryHeap::pop underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxBinaryHeap::pop underflow");
             this->_data[0] = std::move(this->_data[--this->_end]);
             heapify_down(0);
         }
 
-        T extract() override
+        T extract() noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxBinaryHeap::extract underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxBinaryHeap::extract underflow");
             T temp = std::move(this->_data[0]);
             this->_data[0] = std::move(this->_data[--this->_end]);
             heapify_down(0);
@@ -84,29 +100,232 @@ namespace _2Ls
         }
 
     protected:
-        void heapify_up(size_t current)
+        // both walks carry a hole instead of swapping, so each level costs one move
+        void heapify_up(size_t current) noexcept
+        {
+            T value = std::move(this->_data[current]);
+            for (size_t parent; current != 0; current = parent)
+            {
+                if (!_cmp(value, this->_data[parent = (current - 1) / 2]))
+                    break;
+                this->_data[current] = std::move(this->_data[parent]);
+            }
+            this->_data[current] = std::move(value);
+        }
+        void heapify_down(size_t current) noexcept
+        {
+            if (this->_end == 0)
+                return;
+            T value = std::move(this->_data[current]);
+            for (size_t child; (child = 2 * current + 1) < this->_end; current = child)
+            {
+                if (child + 1 < this->_end && _cmp(this->_data[child + 1], this->_data[child]))
+                    ++child;
+                if (!_cmp(this->_data[child], value))
+                    break;
+                this->_data[current] = std::move(this->_data[child]);
+            }
+            this->_data[current] = std::move(value);
+        }
+    };
+
+    // Binary heap over a dense key space [0, key_space) with one entry per key at most. A position
+    // map follows every move so entries can be found, reprioritized and erased in O(log n), and
+    // clear() forgets every position in O(1) by advancing a generation stamp.
+    template <typename T, typename KeyOf, typename Comparator = std::less<T>, bool checked = true>
+    class BoxIndexedBinaryHeap
+        : public BoxArrayBase<T, BoxIndexedBinaryHeap<T, KeyOf, Comparator, checked>, checked>
+    {
+        using Base = BoxArrayBase<T, BoxIndexedBinaryHeap<T, KeyOf, Comparator, checked>, checked>;
+        struct Position
+        {
+            uint32_t slot, stamp;
+        };
+        static constexpr uint32_t npos = UINT32_MAX;
+
+    protected:
+        Comparator _cmp;
+        KeyOf _key_of;
+        size_t _key_space;
+        Position *_positions;
+        uint32_t _generation = 1;
+
+    public:
+        BoxIndexedBinaryHeap(const size_t &size = 0, const size_t &key_space = 0)
+            : Base(size), _cmp(Comparator()), _key_of(KeyOf()), _key_space(key_space),
+              _positions(key_space ? new Position[key_space]() : nullptr) {} // Parameterized constructor
+        BoxIndexedBinaryHeap(const BoxIndexedBinaryHeap &other)
+            : Base(other), _cmp(other._cmp), _key_of(other._key_of), _key_space(other._key_space),
+              _positions(other._key_space ? new Position[other._key_space] : nullptr),
+              _generation(other._generation)
+        {
+            std::copy(other._positions, other._positions + _key_space, _positions);
+        } // Copy constructor
+        BoxIndexedBinaryHeap(BoxIndexedBinaryHeap &&other) noexcept
+            : Base(std::move(other)), _cmp(other._cmp), _key_of(other._key_of),
+              _key_space(other._key_space), _positions(other._positions), _generation(other._generation)
+        {
+            other._key_space = 0, other._positions = nullptr;
+        } // Move constructor
+        BoxIndexedBinaryHeap &operator=(const BoxIndexedBinaryHeap &other)
+        {
+            if (this != &other)
+            {
+                BoxIndexedBinaryHeap temp(other);
+                *this = std::move(temp);
+            }
+            return *this;
+        } // Copy assignment
+        BoxIndexedBinaryHeap &operator=(BoxIndexedBinaryHeap &&other) noexcept
+        {
+            Base::operator=(std::move(other));
+            std::swap(_cmp, other._cmp);
+            std::swap(_key_of, other._key_of);
+            std::swap(_key_space, other._key_space);
+            std::swap(_positions, other._positions);
+            std::swap(_generation, other._generation);
+            return *this;
+        }                                                       // Move assignment
+        ~BoxIndexedBinaryHeap() noexcept { delete[] _positions; } // Default destructor
+
+        size_t key_space() const noexcept { return _key_space; }
+        bool contains(const size_t &key) const noexcept
+        {
+            return _positions[key].stamp == _generation && _positions[key].slot != npos;
+        }
+        const T &get(const size_t &key) const noexcept { return this->_data[_positions[key].slot]; }
+
+        T &at(const size_t &index)
+        {
+            if (index >= this->_end)
+                throw std::out_of_range("_2Ls::BoxIndexedBinaryHeap::at out of range");
+            return this->_data[index];
+        }
+        const T &at(const size_t &index) const
+        {
+            if (index >= this->_end)
+                throw std::out_of_range("_2Ls::BoxIndexedBinaryHeap::at out of range");
+            return this->_data[index];
+        }
+        const T &front() const noexcept(!checked)
+        {
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxIndexedBinaryHeap::front underflow");
+            return this->_data[0];
+        }
+        const T &back() const noexcept(!checked)
+        {
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxIndexedBinaryHeap::back underflow");
+            return this->_data[this->_end - 1];
+        }
+
+        void push(const T &value) noexcept(!checked)
+        {
+            if constexpr (checked)
+            {
+                if (this->_end == this->_max_size)
+                    throw std::overflow_error("_2Ls::BoxIndexedBinaryHeap::push overflow");
+                if (contains(_key_of(value)))
+                    throw std::invalid_argument("_2Ls::BoxIndexedBinaryHeap::push duplicate key");
+            }
+            this->_data[this->_end] = value;
+            heapify_up(this->_end++);
+        }
+        void pop() noexcept(!checked)
+        {
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxIndexedBinaryHeap::pop underflow");
+            remove(0);
+        }
+
+        T extract() noexcept(!checked)
+        {
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxIndexedBinaryHeap::extract underflow");
+            T temp = std::move(this->_data[0]);
+            remove(0);
+            return temp;
+        }
+        // replaces the entry sharing value's key; value must not compare after the old entry
+        void decrease_key(const T &value) noexcept(!checked)
+        {
+            size_t key = _key_of(value);
+            if constexpr (checked)
+            {
+                if (!contains(key))
+                    throw std::invalid_argument("_2Ls::BoxIndexedBinaryHeap::decrease_key missing key");
+                if (_cmp(this->_data[_positions[key].slot], value))
+                    throw std::invalid_argument("_2Ls::BoxIndexedBinaryHeap::decrease_key increases key");
+            }
+            size_t slot = _positions[key].slot;
+            this->_data[slot] = value;
+            heapify_up(slot);
+        }
+        void erase(const size_t &key) noexcept(!checked)
+        {
+            if constexpr (checked)
+                if (!contains(key))
+                    throw std::invalid_argument("_2Ls::BoxIndexedBinaryHeap::erase missing key");
+            remove(_positions[key].slot);
+        }
+        void clear() noexcept
+        {
+            this->_end = 0;
+            if (++_generation == 0) // stamps wrapped around, so forget them the slow way
+                std::fill(_positions, _positions + _key_space, Position{npos, _generation = 1});
+        }
+
+    protected:
+        void place(const size_t &slot, T &&value) noexcept
+        {
+            _positions[_key_of(value)] = {static_cast<uint32_t>(slot), _generation};
+            this->_data[slot] = std::move(value);
+        }
+        void remove(const size_t &slot) noexcept
+        {
+            _positions[_key_of(this->_data[slot])].slot = npos;
+            if (slot == --this->_end)
+                return;
+            T value = std::move(this->_data[this->_end]);
+            if (slot != 0 && _cmp(value, this->_data[(slot - 1) / 2]))
+            {
+                this->_data[slot] = std::move(value);
+                heapify_up(slot);
+            }
+            else
+            {
+                this->_data[slot] = std::move(value);
+                heapify_down(slot);
+            }
+        }
+        void heapify_up(size_t current) noexcept
         {
+            T value = std::move(this->_data[current]);
             for (size_t parent; current != 0; current = parent)
             {
-                if (!_cmp(this->_data[parent = (current - 1) / 2], this->_data[current]))
+                if (!_cmp(value, this->_data[parent = (current - 1) / 2]))
                     break;
-                std::swap(this->_data[parent], this->_data[current]);
+                place(current, std::move(this->_data[parent]));
             }
+            place(current, std::move(value));
         }
-        void heapify_down(size_t current)
+        void heapify_down(size_t current) noexcept
         {
-            for (size_t left, right, priority = current;; current = priority)
+            T value = std::move(this->_data[current]);
+            for (size_t child; (child = 2 * current + 1) < this->_end; current = child)
             {
-                if ((left = 2 * current + 1) < this->_end &&
-                    _cmp(this->_data[left], this->_data[priority]))
-                    priority = left;
-                if ((right = left + 1) < this->_end &&
-                    _cmp(this->_data[right], this->_data[priority]))
-                    priority = right;
-                if (priority == current)
+                if (child + 1 < this->_end && _cmp(this->_data[child + 1], this->_data[child]))
+                    ++child;
+                if (!_cmp(this->_data[child], value))
                     break;
-                std::swap(this->_data[current], this->_data[priority]);
+                place(current, std::move(this->_data[child]));
             }
+            place(current, std::move(value));
         }
     };
 }
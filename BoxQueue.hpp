@@ -1,89 +1,165 @@
 #ifndef BOXQUEUE_HPP
 #define BOXQUEUE_HPP
 
+#include <type_traits>
 #include "BoxArray.hpp"
 
 namespace _2Ls
 {
-    template <typename T>
-    class BoxQueue : public BoxArray<T>
+    // Ring buffer with a power-of-two capacity. Pushing onto a full queue doubles the capacity
+    // instead of overflowing, so a queue can start small and track the size of its live window.
+    template <typename T, bool checked = true>
+    class BoxQueue : public BoxArrayBase<T, BoxQueue<T, checked>, checked>
     {
+        using Base = BoxArrayBase<T, BoxQueue<T, checked>, checked>;
+
     protected:
-        size_t _start = 0;
+        size_t _start = 0; // index of the front, _end counts the elements
 
     public:
-        BoxQueue(const size_t &size = 0, T data[] = nullptr)
-            : BoxArray<T>(size, data) {}                               // Parameterized constructor
-        BoxQueue(std::initializer_list<T> init) : BoxArray<T>(init) {} // Initializer-List constructor
-        BoxQueue(const BoxQueue &) noexcept = default;                 // Copy constructor
-        BoxQueue(BoxQueue &&) noexcept = default;                      // Move constructor
-        BoxQueue &operator=(const BoxQueue &) noexcept = default;      // Copy assignment
-        BoxQueue &operator=(BoxQueue &&) noexcept = default;           // Move assignment
-        ~BoxQueue() noexcept = default;                                // Default destructor
+        // walks the ring from the front; U is T or const T
+        template <typename U>
+        class ring_iterator
+        {
+            U *_data;
+            size_t _mask, _index;
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::remove_const_t<U>;
+            using difference_type = ptrdiff_t;
+            using pointer = U *;
+            using reference = U &;
 
-        T *begin() noexcept override { return this->_data + _start; }
-        const T *begin() const noexcept override { return this->_data + _start; }
+            ring_iterator(U *data, size_t mask, size_t index) noexcept : _data(data), _mask(mask), _index(index) {}
+            U &operator*() const noexcept { return _data[_index & _mask]; }
+            U *operator->() const noexcept { return _data + (_index & _mask); }
+            ring_iterator &operator++() noexcept { return ++_index, *this; }
+            ring_iterator operator++(int) noexcept { return ring_iterator(_data, _mask, _index++); }
+            bool operator==(const ring_iterator &other) const noexcept { return _index == other._index; }
+            bool operator!=(const ring_iterator &other) const noexcept { return _index != other._index; }
+        };
+        using iterator = ring_iterator<T>;
+        using const_iterator = ring_iterator<const T>;
 
-        size_t size() const noexcept override { return this->_end - _start; }
-        bool empty() const noexcept override { return this->_end == _start; }
+        BoxQueue(const size_t &size = 0, T data[] = nullptr)
+            : Base(data ? floor_power_of_two(size) : ceil_power_of_two(size), data) {} // Parameterized constructor
+        BoxQueue(std::initializer_list<T> init) : Base(ceil_power_of_two(init.size()))
+        {
+            for (const T &value : init)
+                push(value);
+        }                                                    // Initializer-List constructor
+        BoxQueue(const BoxQueue &) = default;                // Copy constructor
+        BoxQueue(BoxQueue &&) noexcept = default;            // Move constructor
+        BoxQueue &operator=(const BoxQueue &) = default;     // Copy assignment
+        BoxQueue &operator=(BoxQueue &&) noexcept = default; // Move assignment
+        ~BoxQueue() noexcept = default;                      // Default destructor
 
-        T &at(const size_t &index) override
+        iterator begin() noexcept { return iterator(this->_data, mask(), _start); }
+        const_iterator begin() const noexcept { return const_iterator(this->_data, mask(), _start); }
+        iterator end() noexcept { return iterator(this->_data, mask(), _start + this->_end); }
+        const_iterator end() const noexcept { return const_iterator(this->_data, mask(), _start + this->_end); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend() const noexcept { return end(); }
+        // the ring only walks forwards
+        void rbegin() const = delete;
+        void rend() const = delete;
+        void crbegin() const = delete;
+        void crend() const = delete;
+
+        T &operator[](const size_t &index) noexcept { return this->_data[(_start + index) & mask()]; }
+        const T &operator[](const size_t &index) const noexcept { return this->_data[(_start + index) & mask()]; }
+        T &at(const size_t &index)
         {
             if (index >= this->_end)
                 throw std::out_of_range("_2Ls::BoxQueue::at out of range");
-            return this->_data[index];
+            return (*this)[index];
         }
-        const T &at(const size_t &index) const override
+        const T &at(const size_t &index) const
         {
             if (index >= this->_end)
                 throw std::out_of_range("_2Ls::BoxQueue::at out of range");
-            return this->_data[index];
+            return (*this)[index];
         }
-        T &front() override
+        T &front() noexcept(!checked)
         {
-            if (this->_end - _start == 0)
-                throw std::underflow_error("_2Ls::BoxQueue::front underflow");
-            return this->_data[0];
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxQueue::front underflow");
+            return this->_data[_start];
         }
-        const T &front() const override
+        const T &front() const noexcept(!checked)
         {
-            if (this->_end - _start == 0)
-                throw std::underflow_error("_2Ls::BoxQueue::front underflow");
-            return this->_data[0];
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxQueue::front underflow");
+            return this->_data[_start];
         }
-        T &back() override
+        T &back() noexcept(!checked)
         {
-            if (this->_end - _start == 0)
-                throw std::underflow_error("_2Ls::BoxQueue::back underflow");
-            return this->_data[this->_end - 1];
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxQueue::back underflow");
+            return (*this)[this->_end - 1];
         }
-        const T &back() const override
+        const T &back() const noexcept(!checked)
         {
-            if (this->_end - _start == 0)
-                throw std::underflow_error("_2Ls::BoxQueue::back underflow");
-            return this->_data[this->_end - 1];
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxQueue::back underflow");
+            return (*this)[this->_end - 1];
         }
 
-        void push(const T &value) override
+        void push(const T &value)
         {
             if (this->_end == this->_max_size)
-                throw std::overflow_error("_2Ls::BoxQueue::push overflow");
-            this->_data[this->_end++] = value;
+                grow();
+            this->_data[(_start + this->_end++) & mask()] = value;
         }
-        void pop() override
+        void pop() noexcept(!checked)
         {
-            if (this->_end == _start)
-                throw std::underflow_error("_2Ls::BoxQueue::pop underflow");
-            ++_start;
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxQueue::pop underflow");
+            _start = (_start + 1) & mask(), --this->_end;
         }
 
-        T extract() override
+        T extract() noexcept(!checked)
+        {
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxQueue::extract underflow");
+            T temp = std::move(this->_data[_start]);
+            _start = (_start + 1) & mask(), --this->_end;
+            return temp;
+        }
+        void clear() noexcept { _start = 0, this->_end = 0; }
+
+    protected:
+        size_t mask() const noexcept { return this->_max_size - 1; }
+        void grow()
+        {
+            size_t new_max_size = this->_max_size ? 2 * this->_max_size : 16;
+            T *new_data = new T[new_max_size];
+            for (size_t i = 0; i < this->_end; ++i)
+                new_data[i] = std::move((*this)[i]);
+            this->release();
+            this->_data = new_data, this->_max_size = new_max_size, this->_owner = true, _start = 0;
+        }
+        static size_t ceil_power_of_two(size_t size) noexcept
+        {
+            size_t power = size ? 1 : 0;
+            while (power < size)
+                power <<= 1;
+            return power;
+        }
+        static size_t floor_power_of_two(size_t size) noexcept
         {
-            if (this->_end == _start)
-                throw std::underflow_error("_2Ls::BoxQueue::extract underflow");
-            return this->_data[_start++];
+            size_t power = size ? 1 : 0;
+            while (power && (power << 1) <= size)
+                power <<= 1;
+            return power;
         }
-        void clear() noexcept override { _start = 0, this->_end = 0; }
     };
 }
 
@@ -5,73 +5,81 @@
 
 namespace _2Ls
 {
-    template <typename T>
-    class BoxStack : public BoxArray<T>
+    template <typename T, bool checked = true>
+    class BoxStack : public BoxArrayBase<T, BoxStack<T, checked>, checked>
     {
+        using Base = BoxArrayBase<T, BoxStack<T, checked>, checked>;
+
     public:
-        BoxStack(const size_t &size = 0, T data[] = nullptr)
-            : BoxArray<T>(size, data) {}                               // Parameterized constructor
-        BoxStack(std::initializer_list<T> init) : BoxArray<T>(init) {} // Initializer-List constructor
-        BoxStack(const BoxStack &) noexcept = default;                 // Copy constructor
-        BoxStack(BoxStack &&) noexcept = default;                      // Move constructor
-        BoxStack &operator=(const BoxStack &) noexcept = default;      // Copy assignment
-        BoxStack &operator=(BoxStack &&) noexcept = default;           // Move assignment
-        ~BoxStack() noexcept = default;                                // Default destructor
+        BoxStack(const size_t &size = 0, T data[] = nullptr) : Base(size, data) {} // Parameterized constructor
+        BoxStack(std::initializer_list<T> init) : Base(init) {}                    // Initializer-List constructor
+        BoxStack(const BoxStack &) = default;                                      // Copy constructor
+        BoxStack(BoxStack &&) noexcept = default;                                  // Move constructor
+        BoxStack &operator=(const BoxStack &) = default;                           // Copy assignment
+        BoxStack &operator=(BoxStack &&) noexcept = default;                       // Move assignment
+        ~BoxStack() noexcept = default;                                            // Default destructor
 
-        T &at(const size_t &index) override
+        T &at(const size_t &index)
         {
             if (index >= this->_end)
                 throw std::out_of_range("_2Ls::BoxStack::at out of range");
             return this->_data[index];
         }
-        const T &at(const size_t &index) const override
+        const T &at(const size_t &index) const
         {
             if (index >= this->_end)
                 throw std::out_of_range("_2Ls::BoxStack::at out of range");
             return this->_data[index];
         }
-        T &front() override
+        T &front() noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxStack::front underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxStack::front underflow");
             return this->_data[0];
         }
-        const T &front() const override
+        const T &front() const noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxStack::front underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxStack::front underflow");
             return this->_data[0];
         }
-        T &back() override
+        T &back() noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxStack::back underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxStack::back underflow");
             return this->_data[this->_end - 1];
         }
-        const T &back() const override
+        const T &back() const noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxStack::back underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxStack::back underflow");
             return this->_data[this->_end - 1];
         }
 
-        void push(const T &value) override
+        void push(const T &value) noexcept(!checked)
         {
-            if (this->_end == this->_max_size)
-                throw std::overflow_error("_2Ls::BoxStack::push overflow");
+            if constexpr (checked)
+                if (this->_end == this->_max_size)
+                    throw std::overflow_error("_2Ls::BoxStack::push overflow");
             this->_data[this->_end++] = value;
         }
-        void pop() override
+        void pop() noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxStack::pop underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxStack::pop underflow");
             --this->_end;
         }
 
-        T extract() override
+        T extract() noexcept(!checked)
         {
-            if (this->_end == 0)
-                throw std::underflow_error("_2Ls::BoxStack::extract underflow");
+            if constexpr (checked)
+                if (this->_end == 0)
+                    throw std::underflow_error("_2Ls::BoxStack::extract underflow");
             return this->_data[--this->_end];
         }
     };
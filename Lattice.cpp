@@ -1,23 +1,49 @@
+#include <random>
+
+#include "Chronometer.hpp"
 #include "Lattice.hpp"
 
 #define LOG std::cout
 #define HELP std::cout << "help\n"
 
+// reverses the moves a forward retrace appended from index first on
+static void reverse_route(Lattice::Route &route, const size_t &first) noexcept
+{
+    std::reverse(route.begin() + first, route.end());
+}
+static void reverse_route(PackedRoute &route, const size_t &first) noexcept
+{
+    route.reverse(first, route.size());
+}
+
+// route that only counts its moves, for queries that want how far and not which way
+struct RouteLength
+{
+    size_t length = 0;
+
+    size_t size() const noexcept { return length; }
+    void clear() noexcept { length = 0; }
+    void push_back(const char &) noexcept { ++length; }
+    RouteLength &operator+=(const char &) noexcept { return ++length, *this; }
+};
+static void reverse_route(RouteLength &, const size_t &) noexcept {}
+
 struct Lattice::Node
 {
     id_t id;
     Coordinate position;
     std::vector<Arc *> outgoings, incomings;
     SuperNode *super;
+    id_t local; // index among the internals of super, set by condense()
 
     Node(const id_t id, const Coordinate position) noexcept
-        : id(id), position(position) {}               // Parameterized constructor
-    Node() noexcept = default;                        // Default constructor
-    Node(const Node &) noexcept = default;            // Copy constructor
-    Node(Node &&) noexcept = default;                 // Move constructor
-    Node &operator=(const Node &) noexcept = default; // Copy assignment
-    Node &operator=(Node &&) noexcept = default;      // Move assignment
-    ~Node() noexcept = default;                       // Default destructor
+        : id(id), position(position), super(nullptr), local(0) {} // Parameterized constructor
+    Node() noexcept = default;                                    // Default constructor
+    Node(const Node &) noexcept = default;                        // Copy constructor
+    Node(Node &&) noexcept = default;                             // Move constructor
+    Node &operator=(const Node &) noexcept = default;             // Copy assignment
+    Node &operator=(Node &&) noexcept = default;                  // Move assignment
+    ~Node() noexcept = default;                                   // Default destructor
 };
 
 struct Lattice::Arc
@@ -39,7 +65,9 @@ struct Lattice::SuperNode
 {
     id_t id;
     std::vector<Node *> internals;
+    std::vector<Node *> locals; // internals renumbered 0..k-1 with only the arcs between them
     std::vector<SuperArc *> outgoings, incomings;
+    PortalMemo *portal_routes = nullptr; // legs between portals, made by condense()
 
     SuperNode(const id_t id) noexcept
         : id(id) {}                                             // Parameterized constructor
@@ -51,14 +79,22 @@ struct Lattice::SuperNode
     ~SuperNode() noexcept = default;                            // Default destructor
 };
 
+// One per pair of neighbouring components and direction. exit and link are the first arc found
+// between them, which searches cross by default, and portals lists every such arc.
 struct Lattice::SuperArc
 {
+    struct Portal
+    {
+        Node *exit;
+        Arc *link;
+    };
     SuperNode *next;
     Node *exit;
     Arc *link;
+    std::vector<Portal> portals;
 
-    SuperArc(SuperNode *next, Node *exit, Arc *link) noexcept
-        : next(next), exit(exit), link(link) {}               // Parameterized constructor
+    SuperArc(SuperNode *next, Node *exit, Arc *link)
+        : next(next), exit(exit), link(link), portals{{exit, link}} {} // Parameterized constructor
     SuperArc() noexcept = default;                            // Default constructor
     SuperArc(const SuperArc &) noexcept = default;            // Copy constructor
     SuperArc(SuperArc &&) noexcept = default;                 // Move constructor
@@ -67,13 +103,25 @@ struct Lattice::SuperArc
     ~SuperArc() noexcept = default;                           // Default destructor
 };
 
+// flips the last links from tail back to head so that, from head, last[] leads towards tail and
+// super searches can append their legs front to back in one pass
+static void reverse_chain(Lattice::SuperNode **last, Lattice::SuperNode *head, Lattice::SuperNode *tail) noexcept
+{
+    Lattice::SuperNode *next = nullptr;
+    for (Lattice::SuperNode *current = tail, *previous; current != head; next = current, current = previous)
+    {
+        previous = last[current->id];
+        last[current->id] = next;
+    }
+    last[head->id] = next;
+}
+
 class Lattice::MetaData
 {
 public:
     struct WrappedNode
     {
-        Node *node;
-        size_t cost;
+        uint32_t id, cost;
     };
     enum Mode : char
     {
@@ -93,90 +141,117 @@ public:
     };
 
 private:
-    WrappedNode *open_set;
-    size_t front = 0, back = 0;
-    Node **last;
-    Move *move;
+    struct MinCost
+    {
+        bool operator()(const WrappedNode &a, const WrappedNode &b) const noexcept { return a.cost < b.cost; }
+    };
+    struct MaxCost
+    {
+        bool operator()(const WrappedNode &a, const WrappedNode &b) const noexcept { return a.cost > b.cost; }
+    };
+    struct WrappedNodeId
+    {
+        size_t operator()(const WrappedNode &w) const noexcept { return w.id; }
+    };
+    using Stack = _2Ls::BoxStack<uint32_t, false>;
+    using Queue = _2Ls::BoxQueue<uint32_t, false>;
+    using MinHeap = _2Ls::BoxIndexedBinaryHeap<WrappedNode, WrappedNodeId, MinCost, false>;
+    using MaxHeap = _2Ls::BoxIndexedBinaryHeap<WrappedNode, WrappedNodeId, MaxCost, false>;
+
+    Node *const *nodes;
+    size_t graph_size;
+    bool compact;
+    Stack stack_set;
+    Queue queue_set;
+    MinHeap min_heap_set;
+    MaxHeap max_heap_set;
+    Node **last = nullptr;                        // full state: parent per node
+    Move *move = nullptr;                         // full state: arrival move per node
+    uint8_t *arrival = nullptr;                   // compact state: 2-bit arrival direction per node
+    uint64_t *reached = nullptr;                  // compact state: visited bit per node
+    std::unordered_map<id_t, Node *> ambiguous_last; // compact state: parents a reverse step can't tell apart
+    bool backwards = false;
     Node *start = nullptr, *focus = nullptr;
+    const std::vector<Node *> *foci = nullptr; // multi-goal: h is the distance to the nearest of these
+    Coordinate foci_low, foci_high;            // multi-goal: box around foci, for h once they are many
+    const std::vector<bool> *seeds = nullptr;  // multi-source: retracing stops at any of these
+    size_t depth = 0; // moves from start to the node being expanded (f-cost modes)
     std::function<size_t(const Node *)> *cost_fnptr = nullptr;
-    std::function<void(Node *)> *push_adjacents_fnptr = nullptr;
-    std::function<Node *()> *extract_next_fnptr = nullptr;
+    std::function<void(Node *)> push_adjacents;
+    std::function<Node *()> extract_next_node;
+    std::function<void(Node *)> push_seed;
     Mode mode = NULL_MODE;
+    const std::atomic<bool> *stop = nullptr; // raised by someone else to cut the search short
 
 public:
-    MetaData(const size_t &graph_size)
-        : open_set(new WrappedNode[graph_size]),
-          last(new Node *[graph_size]), move(new Move[graph_size]()) {}       // Parameterized constructor
-    MetaData() : open_set(nullptr), last(nullptr), move(nullptr) {}           // Default constructor
-    MetaData(const MetaData &) noexcept = default;                            // Copy constructor
-    MetaData(MetaData &&) noexcept = default;                                 // Move constructor
-    MetaData &operator=(const MetaData &) noexcept = default;                 // Copy assignment
-    MetaData &operator=(MetaData &&) noexcept = default;                      // Move assignment
-    ~MetaData() noexcept { delete[] open_set, delete[] last, delete[] move; } // Default destructor
+    MetaData(Node *const nodes[], const size_t &node_count, const bool &compact)
+        : nodes(nodes), graph_size(node_count), compact(compact)
+    {
+        if (compact)
+            arrival = new uint8_t[(graph_size + 3) / 4],
+            reached = new uint64_t[(graph_size + 63) / 64]();
+        else
+            last = new Node *[graph_size], move = new Move[graph_size]();
+    } // Parameterized constructor
+    MetaData(const Lattice &lattice)
+        : MetaData(lattice.nodes.data(), lattice.nodes.size(), lattice.compact_state) {} // Lattice constructor
+    MetaData() : nodes(nullptr), graph_size(0), compact(false) {} // Default constructor
+    MetaData(const MetaData &) = delete;                          // Copy constructor
+    MetaData(MetaData &&) = delete;                               // Move constructor
+    MetaData &operator=(const MetaData &) = delete;               // Copy assignment
+    MetaData &operator=(MetaData &&) = delete;                    // Move assignment
+    ~MetaData() noexcept
+    {
+        delete[] last, delete[] move, delete[] arrival, delete[] reached;
+    } // Default destructor
 
     void configure(Node *new_start, Node *new_focus, const Mode &new_mode)
     {
         start = new_start;
         focus = new_focus;
-        if (new_mode == mode)
-            return;
+        foci = nullptr, seeds = nullptr;
+        depth = 0;
+        if (mode != NULL_MODE) // reused by a workspace, so forget the previous query
+            reset();
+        mode = new_mode;
+        backwards = new_mode >= DFS_B;
         switch (new_mode)
         {
         case DFS_F:
-            push_adjacents_fnptr = &static_order_push_outgoings;
-            extract_next_fnptr = &stack_extract_next;
+            static_order<&MetaData::stack_set, &Node::outgoings>();
             return;
         case DFS_B:
-            push_adjacents_fnptr = &static_order_push_incomings;
-            extract_next_fnptr = &stack_extract_next;
+            static_order<&MetaData::stack_set, &Node::incomings>();
             return;
         case BFS_F:
-            push_adjacents_fnptr = &static_order_push_outgoings;
-            extract_next_fnptr = &queue_extract_next;
+            static_order<&MetaData::queue_set, &Node::outgoings>();
             return;
         case BFS_B:
-            push_adjacents_fnptr = &static_order_push_incomings;
-            extract_next_fnptr = &queue_extract_next;
+            static_order<&MetaData::queue_set, &Node::incomings>();
             return;
         case GBFS_F:
-            cost_fnptr = &min_heap_h_cost;
-            push_adjacents_fnptr = &dynamic_order_push_outgoings;
-            extract_next_fnptr = &binary_heap_extract_next;
+            dynamic_order<&MetaData::min_heap_set, &Node::outgoings, false>();
             return;
         case GBFS_B:
-            cost_fnptr = &min_heap_h_cost;
-            push_adjacents_fnptr = &dynamic_order_push_incomings;
-            extract_next_fnptr = &binary_heap_extract_next;
+            dynamic_order<&MetaData::min_heap_set, &Node::incomings, false>();
             return;
         case NGBFS_F:
-            cost_fnptr = &max_heap_h_cost;
-            push_adjacents_fnptr = &dynamic_order_push_outgoings;
-            extract_next_fnptr = &binary_heap_extract_next;
+            dynamic_order<&MetaData::max_heap_set, &Node::outgoings, false>();
             return;
         case NGBFS_B:
-            cost_fnptr = &max_heap_h_cost;
-            push_adjacents_fnptr = &dynamic_order_push_incomings;
-            extract_next_fnptr = &binary_heap_extract_next;
+            dynamic_order<&MetaData::max_heap_set, &Node::incomings, false>();
             return;
         case ASTAR_F:
-            cost_fnptr = &min_heap_f_cost;
-            push_adjacents_fnptr = &dynamic_order_push_outgoings;
-            extract_next_fnptr = &binary_heap_extract_next;
+            dynamic_order<&MetaData::min_heap_set, &Node::outgoings, true>();
             return;
         case ASTAR_B:
-            cost_fnptr = &min_heap_f_cost;
-            push_adjacents_fnptr = &dynamic_order_push_incomings;
-            extract_next_fnptr = &binary_heap_extract_next;
+            dynamic_order<&MetaData::min_heap_set, &Node::incomings, true>();
             return;
         case NASTAR_F:
-            cost_fnptr = &max_heap_f_cost;
-            push_adjacents_fnptr = &dynamic_order_push_outgoings;
-            extract_next_fnptr = &binary_heap_extract_next;
+            dynamic_order<&MetaData::max_heap_set, &Node::outgoings, true>();
             return;
         case NASTAR_B:
-            cost_fnptr = &max_heap_f_cost;
-            push_adjacents_fnptr = &dynamic_order_push_incomings;
-            extract_next_fnptr = &binary_heap_extract_next;
+            dynamic_order<&MetaData::max_heap_set, &Node::incomings, true>();
             return;
         case NULL_MODE:
             // todo throw exception
@@ -185,143 +260,856 @@ public:
     };
     Node *extract_next(Node *n)
     {
-        (*push_adjacents_fnptr)(n);
-        return (*extract_next_fnptr)();
+        if (stop != nullptr && stop->load(std::memory_order_relaxed)) // cancelled searches run dry
+            return nullptr;
+        push_adjacents(n);
+        return extract_next_node();
     }
-    bool visited(Node *n) { return move[n->id] != 0; }
-    Route retrace_route(Node *n)
+    void cancel_on(const std::atomic<bool> *flag) noexcept { stop = flag; }
+    bool visited(Node *n) { return compact ? is_reached(n->id) : move[n->id] != 0; }
+    // the heuristic aims at whichever of targets is nearest instead of at focus
+    void aim(const std::vector<Node *> &targets) noexcept
     {
-        Route route;
-        for (; n != start; n = last[n->id])
-            route.push_back(move[n->id]);
-        return route;
+        foci = &targets;
+        if (targets.empty())
+            return;
+        foci_low = foci_high = targets.front()->position;
+        for (const Node *f : targets)
+        {
+            foci_low = Coordinate(std::min(foci_low.x, f->position.x), std::min(foci_low.y, f->position.y),
+                                  std::min(foci_low.z, f->position.z));
+            foci_high = Coordinate(std::max(foci_high.x, f->position.x), std::max(foci_high.y, f->position.y),
+                                   std::max(foci_high.z, f->position.z));
+        }
+    }
+    // starts from every node in sources at once, as if each one were start
+    void seed(const std::vector<Node *> &sources, const std::vector<bool> &is_source)
+    {
+        seeds = &is_source;
+        for (Node *source : sources)
+            if (!visited(source))
+                push_seed(source);
+    }
+    // the first node of a seeded search, taken without expanding start, which is a seed itself
+    Node *extract_seed()
+    {
+        if (stop != nullptr && stop->load(std::memory_order_relaxed))
+            return nullptr;
+        return extract_next_node();
+    }
+    // appends the moves between n and start in the order the search found them, so a forward
+    // search hands them back reversed, and returns the node the route starts from, start unless
+    // the search was seeded
+    template <typename R>
+    Node *retrace_route(Node *n, R &route)
+    {
+        if (!compact)
+        {
+            for (; n != start && !is_seed(n); n = last[n->id])
+                route.push_back(move[n->id]);
+            return n;
+        }
+        for (; n != start && !is_seed(n); n = compact_last(n))
+            route.push_back(compact_move(n->id));
+        return n;
+    }
+
+    size_t retrace_length(Node *n)
+    {
+        size_t length = 0;
+        for (; n != start; n = compact ? compact_last(n) : last[n->id])
+            ++length;
+        return length;
     }
 
 private:
-    std::function<size_t(const Node *)>
-        min_heap_h_cost = [this](const Node *n) -> size_t
+    // compact state keeps no parent pointers: the arrival move is stored in 2 bits and the
+    // parent is found again by stepping back along it (outgoings for backward searches, where
+    // each direction leads to one node, incomings for forward ones, where several floors can
+    // fall onto the same node and the rare ambiguous parent is kept in ambiguous_last)
+    Move compact_move(const size_t &id) const noexcept
     {
-        int hdx = n->position.x - focus->position.x, hsx = hdx >> int_most_significant_bit,
-            hdy = n->position.y - focus->position.y, hsy = hdy >> int_most_significant_bit,
-            hdz = n->position.z - focus->position.z, hsz = hdz >> int_most_significant_bit;
-        return (hdx ^ hsx) + hsx + (hdy ^ hsy) + hsy + (hdz ^ hsz) + hsz;
-    },
-        max_heap_h_cost = [this](const Node *n) -> size_t
+        return PackedRoute::decode(arrival[id >> 2] >> ((id & 3) << 1));
+    }
+    void reset()
+    {
+        if (compact)
+            std::fill(reached, reached + (graph_size + 63) / 64, 0), ambiguous_last.clear();
+        else
+            std::fill(move, move + graph_size, 0);
+    }
+    bool is_seed(const Node *n) const noexcept { return seeds != nullptr && (*seeds)[n->id]; }
+    bool is_reached(const size_t &id) const noexcept { return reached[id >> 6] >> (id & 63) & 1; }
+    Node *compact_last(Node *n) const
+    {
+        Move m = compact_move(n->id);
+        if (backwards)
+        {
+            for (Arc *arc : n->outgoings)
+                if (arc->move == m)
+                    return arc->next;
+            return nullptr;
+        }
+        if (!ambiguous_last.empty())
+        {
+            auto found = ambiguous_last.find(n->id);
+            if (found != ambiguous_last.end())
+                return found->second;
+        }
+        for (Arc *arc : n->incomings)
+            if (arc->move == m)
+                return arc->next;
+        return nullptr;
+    }
+    template <bool compact_state>
+    bool seen(const Node *n) const noexcept
+    {
+        if constexpr (compact_state)
+            return is_reached(n->id);
+        else
+            return move[n->id] != 0;
+    }
+    template <bool compact_state>
+    void mark(Node *next, Node *current, const Move &m)
+    {
+        if constexpr (compact_state)
+        {
+            size_t id = next->id, shift = (id & 3) << 1;
+            reached[id >> 6] |= uint64_t(1) << (id & 63);
+            arrival[id >> 2] = (arrival[id >> 2] & ~(3 << shift)) | (PackedRoute::encode(m, 0) << shift);
+            if (backwards)
+                return;
+            size_t candidates = 0;
+            for (Arc *arc : next->incomings)
+                candidates += arc->move == m;
+            if (candidates > 1)
+                ambiguous_last[next->id] = current;
+            else if (!ambiguous_last.empty())
+                ambiguous_last.erase(next->id);
+        }
+        else
+            last[next->id] = current, move[next->id] = m;
+    }
+
+    // A node enters the open set once at most, so the stack is sized to the graph. The queue
+    // only ever holds a BFS shell and is a ring that starts small and grows with the frontier.
+    template <auto open_set, auto adjacents>
+    void static_order()
+    {
+        using OpenSet = std::remove_reference_t<decltype(this->*open_set)>;
+        if constexpr (std::is_same_v<OpenSet, Queue>)
+            (this->*open_set).clear();
+        else if ((this->*open_set).max_size() == graph_size)
+            (this->*open_set).clear();
+        else
+            this->*open_set = OpenSet(graph_size);
+        if (compact)
+            bind_static_order<open_set, adjacents, true>();
+        else
+            bind_static_order<open_set, adjacents, false>();
+        extract_next_node = [this]() -> Node *
+        { return (this->*open_set).empty() ? nullptr : nodes[(this->*open_set).extract()]; };
+    }
+    template <auto open_set, auto adjacents, bool compact_state>
+    void bind_static_order()
     {
-        int hdx = n->position.x - focus->position.x, hsx = hdx >> int_most_significant_bit,
-            hdy = n->position.y - focus->position.y, hsy = hdy >> int_most_significant_bit,
-            hdz = n->position.z - focus->position.z, hsz = hdz >> int_most_significant_bit;
+        push_adjacents = [this](Node *current) -> void
+        {
+            for (Arc *arc : current->*adjacents)
+            {
+                if (seen<compact_state>(arc->next))
+                    continue;
+                mark<compact_state>(arc->next, current, arc->move);
+                (this->*open_set).push(arc->next->id);
+            }
+        };
+        push_seed = [this](Node *seed) -> void
+        {
+            mark<compact_state>(seed, nullptr, 'n');
+            (this->*open_set).push(seed->id);
+        };
+    }
+    // With g_cost the key is moves-so-far plus h, and a node still waiting in a min-heap is
+    // re-parented in place through decrease_key when a shorter route to it turns up.
+    template <auto open_set, auto adjacents, bool g_cost>
+    void dynamic_order()
+    {
+        using OpenSet = std::remove_reference_t<decltype(this->*open_set)>;
+        if ((this->*open_set).key_space() == graph_size)
+            (this->*open_set).clear(); // O(1), positions are invalidated by generation
+        else
+            this->*open_set = OpenSet(graph_size, graph_size);
+        cost_fnptr = g_cost ? &f_cost : &h_cost;
+        if (compact)
+            bind_dynamic_order<open_set, adjacents, g_cost, true>();
+        else
+            bind_dynamic_order<open_set, adjacents, g_cost, false>();
+        extract_next_node = [this]() -> Node *
+        {
+            if ((this->*open_set).empty())
+                return nullptr;
+            WrappedNode next = (this->*open_set).extract();
+            if constexpr (g_cost)
+                depth = next.cost - h_cost(nodes[next.id]);
+            return nodes[next.id];
+        };
+    }
+    template <auto open_set, auto adjacents, bool g_cost, bool compact_state>
+    void bind_dynamic_order()
+    {
+        using OpenSet = std::remove_reference_t<decltype(this->*open_set)>;
+        push_adjacents = [this](Node *current) -> void
+        {
+            for (Arc *arc : current->*adjacents)
+            {
+                if (seen<compact_state>(arc->next))
+                {
+                    if constexpr (g_cost && std::is_same_v<OpenSet, MinHeap>)
+                        if ((this->*open_set).contains(arc->next->id))
+                        {
+                            WrappedNode shorter = {arc->next->id, uint32_t((*cost_fnptr)(arc->next))};
+                            if (shorter.cost >= (this->*open_set).get(arc->next->id).cost)
+                                continue;
+                            mark<compact_state>(arc->next, current, arc->move);
+                            (this->*open_set).decrease_key(shorter);
+                        }
+                    continue;
+                }
+                mark<compact_state>(arc->next, current, arc->move);
+                (this->*open_set).push({arc->next->id, uint32_t((*cost_fnptr)(arc->next))});
+            }
+        };
+        push_seed = [this](Node *seed) -> void
+        {
+            mark<compact_state>(seed, nullptr, 'n');
+            (this->*open_set).push({seed->id, uint32_t(h_cost(seed))}); // no moves taken yet
+        };
+    }
+
+    static size_t distance(const Node *n, const Node *f) noexcept
+    {
+        int hdx = n->position.x - f->position.x, hsx = hdx >> int_most_significant_bit,
+            hdy = n->position.y - f->position.y, hsy = hdy >> int_most_significant_bit,
+            hdz = n->position.z - f->position.z, hsz = hdz >> int_most_significant_bit;
         return (hdx ^ hsx) - hsx + (hdy ^ hsy) - hsy + (hdz ^ hsz) - hsz;
+    }
+    // Past exact_foci goals, h falls back from the nearest goal to the box around them all, which
+    // never says more than the nearest goal would and costs the same for any number of them.
+    static constexpr size_t exact_foci = 8;
+    std::function<size_t(const Node *)>
+        h_cost = [this](const Node *n) -> size_t
+    {
+        if (foci == nullptr)
+            return distance(n, focus);
+        if (foci->size() > exact_foci)
+            return std::max({foci_low.x - n->position.x, n->position.x - foci_high.x, 0}) +
+                   std::max({foci_low.y - n->position.y, n->position.y - foci_high.y, 0}) +
+                   std::max({foci_low.z - n->position.z, n->position.z - foci_high.z, 0});
+        size_t nearest = SIZE_MAX;
+        for (const Node *f : *foci)
+            nearest = std::min(nearest, distance(n, f));
+        return nearest;
     },
-        min_heap_f_cost = [this](const Node *n) -> size_t
-    {
-        int gdx = n->position.x - start->position.x, gsx = gdx >> int_most_significant_bit,
-            gdy = n->position.y - start->position.y, gsy = gdy >> int_most_significant_bit,
-            gdz = n->position.z - start->position.z, gsz = gdz >> int_most_significant_bit,
-            hdx = n->position.x - focus->position.x, hsx = hdx >> int_most_significant_bit,
-            hdy = n->position.y - focus->position.y, hsy = hdy >> int_most_significant_bit,
-            hdz = n->position.z - focus->position.z, hsz = hdz >> int_most_significant_bit;
-        return (gdx ^ gsx) + gsx + (gdy ^ gsy) + gsy + (gdz ^ gsz) + gsz +
-               (hdx ^ hsx) + hsx + (hdy ^ hsy) + hsy + (hdz ^ hsz) + hsz;
-    },
-        max_heap_f_cost = [this](const Node *n) -> size_t
-    {
-        int gdx = n->position.x - start->position.x, gsx = gdx >> int_most_significant_bit,
-            gdy = n->position.y - start->position.y, gsy = gdy >> int_most_significant_bit,
-            gdz = n->position.z - start->position.z, gsz = gdz >> int_most_significant_bit,
-            hdx = n->position.x - focus->position.x, hsx = hdx >> int_most_significant_bit,
-            hdy = n->position.y - focus->position.y, hsy = hdy >> int_most_significant_bit,
-            hdz = n->position.z - focus->position.z, hsz = hdz >> int_most_significant_bit;
-        return (gdx ^ gsx) - gsx + (gdy ^ gsy) - gsy + (gdz ^ gsz) - gsz +
-               (hdx ^ hsx) - hsx + (hdy ^ hsy) - hsy + (hdz ^ hsz) - hsz;
-    };
+        f_cost = [this](const Node *n) -> size_t
+    { return depth + 1 + h_cost(n); };
+};
 
-    std::function<void(Node *)>
-        static_order_push_outgoings = [this](Node *current) -> void
+// Storage for expand_levels: the atomic bitset of reached nodes, each node's parent and arrival
+// move when asked for, and the frontier buffers. Reset rather than reallocated between searches,
+// so only the bitset is cleared.
+class Lattice::Levels
+{
+public:
+    std::atomic<uint64_t> *reached = nullptr;
+    Node **last = nullptr; // null until a search asks for parents
+    Move *move = nullptr;
+    std::vector<Node *> frontier, next;
+    std::vector<uint64_t> in_frontier;
+    std::vector<std::vector<Node *>> claimed; // per worker
+    std::vector<size_t> claimed_arcs;
+
+    Levels() noexcept = default;                                            // Default constructor
+    Levels(const Levels &) = delete;                                        // Copy constructor
+    Levels(Levels &&) = delete;                                             // Move constructor
+    Levels &operator=(const Levels &) = delete;                             // Copy assignment
+    Levels &operator=(Levels &&) = delete;                                  // Move assignment
+    ~Levels() noexcept { delete[] reached, delete[] last, delete[] move; } // Default destructor
+
+    // sizes the storage for node_count nodes and forgets whatever the last search reached
+    void reset(const size_t &node_count, const bool &parents)
     {
-        for (Arc *arc : current->outgoings)
+        size_t words = (node_count + 63) / 64;
+        if (node_count != size)
         {
-            if (move[arc->next->id])
-                continue;
-            last[arc->next->id] = current;
-            move[arc->next->id] = arc->move;
-            open_set[back++].node = arc->next;
+            delete[] reached, delete[] last, delete[] move;
+            last = nullptr, move = nullptr;
+            reached = new std::atomic<uint64_t>[words]();
+            size = node_count;
         }
-    },
-        static_order_push_incomings = [this](Node *current) -> void
+        else
+            for (size_t word = 0; word < words; ++word)
+                reached[word].store(0, std::memory_order_relaxed);
+        if (parents && last == nullptr)
+        {
+            last = new Node *[node_count];
+            move = new Move[node_count];
+        }
+    }
+    bool is_reached(const size_t &id) const noexcept
     {
-        for (Arc *arc : current->incomings)
+        return reached[id >> 6].load(std::memory_order_relaxed) >> (id & 63) & 1;
+    }
+
+private:
+    size_t size = 0;
+};
+
+// Search state for one thread, reused from query to query instead of reallocated.
+class Lattice::Workspace
+{
+public:
+    MetaData meta_data_f, meta_data_b;
+    Levels levels; // for direction-optimizing BFS
+
+    Workspace(const Lattice &lattice)
+        : meta_data_f(lattice), meta_data_b(lattice), graph_size(lattice.nodes.size()) {} // Parameterized constructor
+    Workspace(const Lattice &lattice, const SuperNode *component)
+        : meta_data_f(component->locals.data(), component->locals.size(), lattice.compact_state),
+          meta_data_b(component->locals.data(), component->locals.size(), lattice.compact_state),
+          graph_size(component->locals.size()) {} // Component constructor, for searches on its locals
+    Workspace(const Workspace &) = delete;                       // Copy constructor
+    Workspace(Workspace &&) = delete;                            // Move constructor
+    Workspace &operator=(const Workspace &) = delete;            // Copy assignment
+    Workspace &operator=(Workspace &&) = delete;                 // Move assignment
+    ~Workspace() noexcept { delete[] meeting_marks; }            // Default destructor
+
+    // searches run on this workspace give up, reporting no route, once flag is raised
+    void cancel_on(const std::atomic<bool> *flag) noexcept
+    {
+        stop = flag;
+        meta_data_f.cancel_on(flag), meta_data_b.cancel_on(flag);
+    }
+    const std::atomic<bool> *cancellation() const noexcept { return stop; }
+    bool cancelled() const noexcept { return stop != nullptr && stop->load(std::memory_order_relaxed); }
+
+    // Parallel bidirectional searches mark the nodes each side has reached in one shared array, as
+    // generation << 2 | sides, so a new search forgets the last one by bumping the generation.
+    void begin_meeting()
+    {
+        if (meeting_marks == nullptr)
+            meeting_marks = new std::atomic<uint32_t>[graph_size]();
+        if (++meeting_generation == 1u << 30) // stamps ran out, so forget them the slow way
         {
-            if (move[arc->next->id])
-                continue;
-            last[arc->next->id] = current;
-            move[arc->next->id] = arc->move;
-            open_set[back++].node = arc->next;
+            for (size_t id = 0; id < graph_size; ++id)
+                meeting_marks[id].store(0, std::memory_order_relaxed);
+            meeting_generation = 1;
         }
-    },
-        dynamic_order_push_outgoings = [this](Node *current) -> void
+    }
+    // marks n as reached from side (1 forward, 2 backward) and returns the other side if it was there first
+    uint32_t meet(const Node *n, const uint32_t &side) noexcept
     {
-        for (Arc *arc : current->outgoings)
+        std::atomic<uint32_t> &mark = meeting_marks[n->id];
+        uint32_t stamp = meeting_generation << 2, seen = mark.load(std::memory_order_relaxed);
+        while (!mark.compare_exchange_weak(seen, ((seen & ~3u) == stamp ? seen : stamp) | side,
+                                           std::memory_order_relaxed))
+            ;
+        return (seen & ~3u) == stamp ? seen & 3 & ~side : 0;
+    }
+
+private:
+    size_t graph_size;
+    const std::atomic<bool> *stop = nullptr;
+    std::atomic<uint32_t> *meeting_marks = nullptr;
+    uint32_t meeting_generation = 0;
+};
+
+// Runs task(i, workspace) for every i below count on the scheduler's threads, each slot keeping a
+// single workspace for all the tasks it runs. threads = 0 uses every thread of the scheduler.
+template <typename Task>
+static void parallel_for(const Lattice &lattice, _2Ls::TaskScheduler &scheduler, const size_t &count,
+                         const size_t &grain, const size_t &threads, const Task &task)
+{
+    std::vector<std::unique_ptr<Lattice::Workspace>> workspaces(scheduler.thread_count());
+    scheduler.parallel_chunks(count, grain, threads, [&](const size_t &first, const size_t &last, const size_t &slot)
+                              {
+                                  if (workspaces[slot] == nullptr)
+                                      workspaces[slot].reset(new Lattice::Workspace(lattice));
+                                  for (size_t i = first; i < last; ++i)
+                                      task(i, *workspaces[slot]); });
+}
+
+// Reverse expansion from one target: for every node that can reach it, the first move of a
+// shortest route there (2 bits) and the length of that route.
+class Lattice::FlowField
+{
+public:
+    static constexpr uint32_t unreached = UINT32_MAX;
+    const id_t target;
+    const size_t node_count;
+    uint8_t *const moves;
+    uint32_t *const distances;
+
+    FlowField(const id_t &target, const size_t &node_count)
+        : target(target), node_count(node_count), moves(new uint8_t[(node_count + 3) / 4]()),
+          distances(new uint32_t[node_count])
+    {
+        std::fill(distances, distances + node_count, unreached);
+    }                                                              // Parameterized constructor
+    FlowField(const FlowField &) = delete;                         // Copy constructor
+    FlowField(FlowField &&) = delete;                              // Move constructor
+    FlowField &operator=(const FlowField &) = delete;              // Copy assignment
+    FlowField &operator=(FlowField &&) = delete;                   // Move assignment
+    ~FlowField() noexcept { delete[] moves, delete[] distances; } // Default destructor
+
+    id_t key() const noexcept { return target; }
+    size_t bytes() const noexcept { return sizeof(FlowField) + (node_count + 3) / 4 + node_count * sizeof(uint32_t); }
+    Move move(const size_t &id) const noexcept { return PackedRoute::decode(moves[id >> 2] >> ((id & 3) << 1)); }
+    void set_move(const size_t &id, const Move &move) noexcept
+    {
+        moves[id >> 2] |= PackedRoute::encode(move, 0) << ((id & 3) << 1);
+    }
+};
+
+// Least recently used entries keyed by T::key(), evicted once their total T::bytes() passes the
+// budget. Entries are shared, so one that is evicted stays valid for whoever still holds it.
+template <typename T>
+class SharedLruCache
+{
+protected:
+    using Entry = std::shared_ptr<const T>;
+    std::mutex lock;
+    size_t budget, used = 0;
+    std::list<Entry> recency; // most recently used first
+    std::unordered_map<id_t, typename std::list<Entry>::iterator> index;
+
+public:
+    SharedLruCache(const size_t &budget) : budget(budget) {}        // Parameterized constructor
+    SharedLruCache(const SharedLruCache &) = delete;                // Copy constructor
+    SharedLruCache(SharedLruCache &&) = delete;                     // Move constructor
+    SharedLruCache &operator=(const SharedLruCache &) = delete;     // Copy assignment
+    SharedLruCache &operator=(SharedLruCache &&) = delete;          // Move assignment
+    ~SharedLruCache() noexcept = default;                           // Default destructor
+
+    Entry find(const id_t &key)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return touch(key);
+    }
+    // keeps the entry already cached under the same key if another thread got there first
+    Entry insert(const Entry &entry)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = index.find(entry->key());
+        if (found != index.end())
+            return *found->second;
+        recency.push_front(entry);
+        index[entry->key()] = recency.begin();
+        used += entry->bytes();
+        evict();
+        return entry;
+    }
+    void set_budget(const size_t &bytes)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        budget = bytes;
+        evict();
+    }
+
+protected:
+    Entry touch(const id_t &key)
+    {
+        auto found = index.find(key);
+        if (found == index.end())
+            return nullptr;
+        recency.splice(recency.begin(), recency, found->second);
+        return *found->second;
+    }
+    void evict()
+    {
+        while (used > budget && !recency.empty())
         {
-            if (move[arc->next->id])
-                continue;
-            last[arc->next->id] = current;
-            move[arc->next->id] = arc->move;
-            open_set[back] = {arc->next, (*cost_fnptr)(arc->next)};
-            heapify_up(back++);
+            used -= recency.back()->bytes();
+            index.erase(recency.back()->key());
+            recency.pop_back();
         }
-    },
-        dynamic_order_push_incomings = [this](Node *current) -> void
+    }
+};
+
+class Lattice::FlowFieldCache : public SharedLruCache<FlowField>
+{
+public:
+    using SharedLruCache::SharedLruCache;
+};
+
+// Shortest-path tree out of one source: the 2-bit arrival move of every node it reaches. As in
+// compact MetaData, parents are found again by stepping back along the move, and the few nodes
+// that several floors fall onto with the same move keep theirs in ambiguous_last.
+class Lattice::SourceTree
+{
+public:
+    const id_t source;
+    const size_t node_count;
+    uint8_t *const moves;
+    uint64_t *const reached;
+    std::unordered_map<id_t, Node *> ambiguous_last;
+
+    SourceTree(const id_t &source, const size_t &node_count)
+        : source(source), node_count(node_count), moves(new uint8_t[(node_count + 3) / 4]()),
+          reached(new uint64_t[(node_count + 63) / 64]()) {} // Parameterized constructor
+    SourceTree(const SourceTree &) = delete;                  // Copy constructor
+    SourceTree(SourceTree &&) = delete;                       // Move constructor
+    SourceTree &operator=(const SourceTree &) = delete;       // Copy assignment
+    SourceTree &operator=(SourceTree &&) = delete;            // Move assignment
+    ~SourceTree() noexcept { delete[] moves, delete[] reached; } // Default destructor
+
+    id_t key() const noexcept { return source; }
+    size_t bytes() const noexcept
     {
-        for (Arc *arc : current->incomings)
+        return sizeof(SourceTree) + (node_count + 3) / 4 + (node_count + 63) / 64 * sizeof(uint64_t) +
+               ambiguous_last.size() * (sizeof(id_t) + sizeof(Node *) + 2 * sizeof(void *));
+    }
+    bool is_reached(const size_t &id) const noexcept { return reached[id >> 6] >> (id & 63) & 1; }
+    Move move(const size_t &id) const noexcept { return PackedRoute::decode(moves[id >> 2] >> ((id & 3) << 1)); }
+    void reach(Node *next, Node *current, const Move &move)
+    {
+        size_t id = next->id;
+        reached[id >> 6] |= uint64_t(1) << (id & 63);
+        moves[id >> 2] |= PackedRoute::encode(move, 0) << ((id & 3) << 1);
+        size_t candidates = 0;
+        for (Arc *arc : next->incomings)
+            candidates += arc->move == move;
+        if (candidates > 1)
+            ambiguous_last[id] = current;
+    }
+    Node *last(Node *n) const
+    {
+        if (!ambiguous_last.empty())
         {
-            if (move[arc->next->id])
-                continue;
-            last[arc->next->id] = current;
-            move[arc->next->id] = arc->move;
-            open_set[back] = {arc->next, (*cost_fnptr)(arc->next)};
-            heapify_up(back++);
+            auto found = ambiguous_last.find(n->id);
+            if (found != ambiguous_last.end())
+                return found->second;
         }
-    };
+        Move m = move(n->id);
+        for (Arc *arc : n->incomings)
+            if (arc->move == m)
+                return arc->next;
+        return nullptr;
+    }
+};
 
-    std::function<Node *()>
-        stack_extract_next = [this]() -> Node *
-    { return (back != 0) ? open_set[--back].node : nullptr; },
-        queue_extract_next = [this]() -> Node *
-    { return (front != back) ? open_set[front++].node : nullptr; },
-        binary_heap_extract_next = [this]() -> Node *
+// Source trees for the sources queried most. Each query from an uncached source heats it, and
+// one that reaches hot_query_count is worth a tree, which only the query that made it hot builds;
+// the others run bfs meanwhile. Heat halves every aging_period queries, or as soon as a shard
+// tracks max_heated sources, so only sources that stay popular keep their place and the heat
+// table stays bounded. Like the route cache, sources are split over shards with their own lock
+// and an even share of the budget, so a batch of BFS queries rarely waits on another thread, and
+// an empty budget switches the cache off without taking any lock.
+class Lattice::SourceTreeCache
+{
+    static constexpr uint32_t hot_query_count = 8, building = UINT32_MAX;
+    static constexpr size_t aging_period = 1 << 12, max_heated = 1 << 12;
+    class Shard : public SharedLruCache<SourceTree>
     {
-        if (front == back)
+        std::unordered_map<id_t, uint32_t> heat; // building while a tree is on its way
+        size_t queries = 0;
+
+    public:
+        Shard() : SharedLruCache(0) {} // Default constructor
+
+        // returns the cached tree, or nullptr and sets hot when source has just become hot, in
+        // which case the caller owes the shard a call to insert() or abandon()
+        Entry find(const id_t &source, bool &hot)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            Entry tree = touch(source);
+            if (tree != nullptr)
+                return tree;
+            if (++queries % aging_period == 0 || heat.size() >= max_heated)
+                for (auto it = heat.begin(); it != heat.end();)
+                {
+                    if (it->second != building && (it->second >>= 1) == 0)
+                        it = heat.erase(it);
+                    else
+                        ++it;
+                }
+            uint32_t &count = heat[source];
+            if (count != building && ++count == hot_query_count)
+                count = building, hot = true;
             return nullptr;
-        Node *temp = open_set[0].node;
-        open_set[0] = std::move(open_set[--back]);
-        heapify_down(0);
-        return temp;
+        }
+        Entry insert(const Entry &tree)
+        {
+            abandon(tree->key());
+            return SharedLruCache::insert(tree);
+        }
+        void abandon(const id_t &source)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            heat.erase(source);
+        }
+    };
+    static constexpr size_t shard_count = 16;
+    Shard shards[shard_count];
+    std::atomic<size_t> shard_budget{0};
+
+public:
+    SourceTreeCache(const size_t &budget) { set_budget(budget); } // Parameterized constructor
+    SourceTreeCache(const SourceTreeCache &) = delete;            // Copy constructor
+    SourceTreeCache(SourceTreeCache &&) = delete;                 // Move constructor
+    SourceTreeCache &operator=(const SourceTreeCache &) = delete; // Copy assignment
+    SourceTreeCache &operator=(SourceTreeCache &&) = delete;      // Move assignment
+    ~SourceTreeCache() noexcept = default;                        // Default destructor
+
+    bool enabled() const noexcept { return shard_budget.load(std::memory_order_relaxed) != 0; }
+    std::shared_ptr<const SourceTree> find(const id_t &source, bool &hot)
+    {
+        return shards[source % shard_count].find(source, hot);
+    }
+    // keeps the tree already cached for the same source if another thread got there first
+    std::shared_ptr<const SourceTree> insert(const std::shared_ptr<const SourceTree> &tree)
+    {
+        return shards[tree->key() % shard_count].insert(tree);
+    }
+    void abandon(const id_t &source) { shards[source % shard_count].abandon(source); }
+    void set_budget(const size_t &bytes)
+    {
+        shard_budget.store(bytes / shard_count, std::memory_order_relaxed);
+        for (Shard &shard : shards)
+            shard.set_budget(bytes / shard_count);
+    }
+};
+
+// Routes of past queries keyed by (source, target, mode, sub mode), split into shards that each
+// keep their own lock and recency list so concurrent searches rarely wait on each other. An empty
+// budget switches the cache off, which callers can check without taking any lock.
+class Lattice::RouteCache
+{
+public:
+    static constexpr char node_search = -1; // sub mode of keys that are not super searches
+    struct Key
+    {
+        id_t source, target;
+        char mode, sub_mode;
+        bool operator==(const Key &other) const noexcept
+        {
+            return source == other.source && target == other.target &&
+                   mode == other.mode && sub_mode == other.sub_mode;
+        }
     };
 
-    void heapify_up(size_t current)
+private:
+    struct KeyHash
     {
-        for (size_t parent; current != 0; current = parent)
+        size_t operator()(const Key &key) const noexcept
         {
-            parent = (current - 1) / 2;
-            if (open_set[parent].cost <= open_set[current].cost)
-                break;
-            std::swap(open_set[parent], open_set[current]);
+            size_t hash = (size_t(key.source) << 32 | key.target) * 0x9e3779b97f4a7c15ULL;
+            return hash ^ (size_t(uint8_t(key.mode)) << 8 | uint8_t(key.sub_mode)) ^ hash >> 29;
         }
+    };
+    struct Entry
+    {
+        Key key;
+        bool found;
+        PackedRoute route;
+        size_t bytes() const noexcept { return sizeof(Entry) + 2 * sizeof(void *) + route.word_count() * sizeof(uint64_t); }
+    };
+    struct Shard
+    {
+        std::mutex lock;
+        size_t used = 0;
+        std::list<Entry> recency; // most recently used first
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    };
+    static constexpr size_t shard_count = 16;
+    Shard shards[shard_count];
+    std::atomic<size_t> shard_budget{0};
+    std::atomic<size_t> hits{0}, misses{0}, evictions{0};
+
+public:
+    RouteCache() = default;                                 // Default constructor
+    RouteCache(const RouteCache &) = delete;                // Copy constructor
+    RouteCache(RouteCache &&) = delete;                     // Move constructor
+    RouteCache &operator=(const RouteCache &) = delete;     // Copy assignment
+    RouteCache &operator=(RouteCache &&) = delete;          // Move assignment
+    ~RouteCache() noexcept = default;                       // Default destructor
+
+    bool enabled() const noexcept { return shard_budget.load(std::memory_order_relaxed) != 0; }
+
+    // appends the cached route on a hit and reports whether it was found
+    template <typename R>
+    bool find(const Key &key, bool &found, R &route)
+    {
+        Shard &shard = shard_of(key);
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            auto entry = shard.index.find(key);
+            if (entry != shard.index.end())
+            {
+                shard.recency.splice(shard.recency.begin(), shard.recency, entry->second);
+                found = entry->second->found;
+                const PackedRoute &cached = entry->second->route;
+                for (size_t i = 0; i < cached.size(); ++i)
+                    route.push_back(cached[i]);
+                hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
-    void heapify_down(size_t current)
+    template <typename R>
+    void insert(const Key &key, const bool &found, const R &route)
     {
-        for (size_t left, right, priority = current;; current = priority)
+        PackedRoute packed(route.size());
+        for (size_t i = 0; i < route.size(); ++i)
+            packed.push_back(route[i]);
+        Shard &shard = shard_of(key);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        if (shard.index.find(key) != shard.index.end()) // another thread got there first
+            return;
+        shard.recency.push_front(Entry{key, found, std::move(packed)});
+        shard.index[key] = shard.recency.begin();
+        shard.used += shard.recency.front().bytes();
+        evict(shard, shard_budget.load(std::memory_order_relaxed));
+    }
+    void set_budget(const size_t &bytes)
+    {
+        shard_budget.store(bytes / shard_count, std::memory_order_relaxed);
+        for (Shard &shard : shards)
         {
-            if ((left = 2 * current + 1) < back && open_set[left].cost > open_set[priority].cost)
-                priority = left;
-            if ((right = left + 1) < back && open_set[right].cost > open_set[priority].cost)
-                priority = right;
-            if (priority == current)
-                break;
-            std::swap(open_set[current], open_set[priority]);
+            std::lock_guard<std::mutex> guard(shard.lock);
+            evict(shard, bytes / shard_count);
+        }
+    }
+    void clear()
+    {
+        for (Shard &shard : shards)
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            evict(shard, 0);
+        }
+    }
+    RouteCacheStats stats()
+    {
+        RouteCacheStats stats{hits.load(), misses.load(), evictions.load(), 0};
+        for (Shard &shard : shards)
+        {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            stats.bytes += shard.used;
+        }
+        return stats;
+    }
+
+private:
+    Shard &shard_of(const Key &key) noexcept { return shards[KeyHash()(key) % shard_count]; }
+    void evict(Shard &shard, const size_t &budget)
+    {
+        while (shard.used > budget && !shard.recency.empty())
+        {
+            shard.used -= shard.recency.back().bytes();
+            shard.index.erase(shard.recency.back().key);
+            shard.recency.pop_back();
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Routes between the portals of one component, keyed by entry, exit and sub mode and filled as
+// super searches resolve their legs. A leg never leaves its component, so the table only goes
+// stale when condense() replaces the component, and it stops growing at max_routes.
+class Lattice::PortalMemo
+{
+    struct Key
+    {
+        id_t entry, exit;
+        char mode;
+        bool operator==(const Key &other) const noexcept
+        {
+            return entry == other.entry && exit == other.exit && mode == other.mode;
+        }
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const noexcept
+        {
+            size_t hash = (size_t(key.entry) << 32 | key.exit) * 0x9e3779b97f4a7c15ULL;
+            return hash ^ uint8_t(key.mode) ^ hash >> 29;
         }
+    };
+    std::mutex lock;
+    std::unordered_map<Key, PackedRoute, KeyHash> routes;
+
+public:
+    static constexpr size_t max_routes = 1 << 12;
+
+    PortalMemo() = default;                             // Default constructor
+    PortalMemo(const PortalMemo &) = delete;            // Copy constructor
+    PortalMemo(PortalMemo &&) = delete;                 // Move constructor
+    PortalMemo &operator=(const PortalMemo &) = delete; // Copy assignment
+    PortalMemo &operator=(PortalMemo &&) = delete;      // Move assignment
+    ~PortalMemo() noexcept = default;                   // Default destructor
+
+    // appends the memoized leg on a hit
+    template <typename R>
+    bool find(const Node *entry, const Node *exit, const SearchMode &mode, R &route)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = routes.find(Key{entry->id, exit->id, mode});
+        if (found == routes.end())
+            return false;
+        for (size_t i = 0; i < found->second.size(); ++i)
+            route.push_back(found->second[i]);
+        return true;
+    }
+    template <typename R>
+    void insert(const Node *entry, const Node *exit, const SearchMode &mode, const R &route)
+    {
+        PackedRoute packed(route.size());
+        for (size_t i = 0; i < route.size(); ++i)
+            packed.push_back(route[i]);
+        std::lock_guard<std::mutex> guard(lock);
+        if (routes.size() < max_routes)
+            routes.emplace(Key{entry->id, exit->id, mode}, std::move(packed));
+    }
+};
+
+// Lock-free many-producer, one-consumer mailbox. Producers push whole batches onto a Treiber
+// stack and the owner takes everything at once, so neither side ever waits on the other. Pushes
+// and empty() are sequentially consistent, so an owner that flags itself idle and then finds the
+// stack empty can't miss a batch whose producer saw it busy.
+template <typename T>
+class MpscMailbox
+{
+public:
+    struct Batch
+    {
+        Batch *next;
+        std::vector<T> items;
+    };
+
+private:
+    std::atomic<Batch *> head{nullptr};
+
+public:
+    MpscMailbox() = default;                                // Default constructor
+    MpscMailbox(const MpscMailbox &) = delete;              // Copy constructor
+    MpscMailbox(MpscMailbox &&) = delete;                   // Move constructor
+    MpscMailbox &operator=(const MpscMailbox &) = delete;   // Copy assignment
+    MpscMailbox &operator=(MpscMailbox &&) = delete;        // Move assignment
+    ~MpscMailbox() noexcept
+    {
+        for (Batch *batch = take_all(), *next; batch != nullptr; batch = next)
+            next = batch->next, delete batch;
+    } // Default destructor
+
+    bool empty() const noexcept { return head.load() == nullptr; }
+    void push(Batch *batch) noexcept
+    {
+        batch->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(batch->next, batch, std::memory_order_seq_cst, std::memory_order_relaxed))
+            ;
     }
+    Batch *take_all() noexcept { return head.exchange(nullptr, std::memory_order_acquire); }
 };
 
 #define VOID 7
@@ -345,6 +1133,10 @@ Lattice::Lattice(const FilePath &file_path) // todo handle bad parse
         throw std::runtime_error("Could not open " + file_path);
 
     origin_file_path = file_path;
+    flow_fields = std::make_shared<FlowFieldCache>(64 << 20);
+    source_trees = std::make_shared<SourceTreeCache>(64 << 20);
+    routes = std::make_shared<RouteCache>();
+    scheduler = std::make_shared<_2Ls::TaskScheduler>();
 
     // initialize world bounds
     data >> x_size >> y_size >> z_size;
@@ -400,6 +1192,7 @@ Lattice::Lattice(const FilePath &file_path) // todo handle bad parse
                         if (schematic[schematic_index] == NEW_NODE)
                         {
                             graph[current_position] = new Lattice::Node(id++, current_position);
+                            nodes.push_back(graph[current_position]);
                             Coordinate u = current_position;
                             if (current_position.x != 0 &&
                                 schematic[schematic_index WEST] HAS_ADJACENCY)
@@ -456,6 +1249,7 @@ Lattice::Lattice(const FilePath &file_path) // todo handle bad parse
                 }
         }
     }
+    profile_world();
 }
 
 Lattice::~Lattice() noexcept
@@ -474,6 +1268,15 @@ Lattice::~Lattice() noexcept
             delete superarc;
         for (const auto &superarc : supernode->incomings)
             delete superarc;
+        for (const auto &local : supernode->locals)
+        {
+            for (const auto &arc : local->outgoings)
+                delete arc;
+            for (const auto &arc : local->incomings)
+                delete arc;
+            delete local;
+        }
+        delete supernode->portal_routes;
         delete supernode;
     }
 }
@@ -498,34 +1301,96 @@ Coordinate Lattice::travel(const Coordinate &source, const Route &route) const
     return current->position;
 }
 
-void Lattice::condense() noexcept
+Coordinate Lattice::travel(const Coordinate &source, const PackedRoute &route) const
+{
+    if (graph.find(source) == graph.end()) // check source validity
+        throw InvalidSource(source);
+    Node *current = graph.at(source);
+    for (size_t i = 0; i < route.size(); ++i)
+    {
+        Node *next = nullptr;
+        for (Arc *arc : current->outgoings)
+        {
+            if (arc->move == route[i])
+                next = arc->next;
+        }
+        if (next == nullptr)
+            throw InvalidRoute(route[i], i);
+        current = next;
+    }
+    return current->position;
+}
+
+void Lattice::condense() noexcept
 {
     int *visit_time = new int[graph.size()]();
     int *low_link = new int[graph.size()]();
     bool *is_on_stack = new bool[graph.size()]();
-    std::stack<Node *> stack;
+    _2Ls::BoxStack<Node *, false> stack(graph.size());
     int current_time = 0;
     id_t id = 0;
     for (auto [position, node] : graph)
         if (visit_time[node->id] == 0)
             tarjan_dfs(node, visit_time, low_link, is_on_stack, stack, current_time, id);
+    if (routes != nullptr) // super routes cached so far came from the old condensation
+        routes->clear();
     delete[] visit_time;
     delete[] low_link;
     delete[] is_on_stack;
+    SuperArc **arc_to = new SuperArc *[congraph.size()](), **arc_from = new SuperArc *[congraph.size()]();
     for (SuperNode *super_node : congraph)
+    {
+        super_node->portal_routes = new PortalMemo;
+        for (size_t i = 0; i < super_node->internals.size(); ++i)
+            super_node->internals[i]->local = i;
         for (Node *node : super_node->internals)
         {
             for (Arc *arc : node->outgoings)
-                if (arc->next->super != super_node)
-                    super_node->outgoings.push_back(new SuperArc(arc->next->super, node, arc));
+            {
+                SuperNode *next = arc->next->super;
+                if (next == super_node)
+                    continue;
+                if (arc_to[next->id] != nullptr && arc_to[next->id]->exit->super == super_node) // seen from here
+                    arc_to[next->id]->portals.push_back({node, arc});
+                else
+                    super_node->outgoings.push_back(arc_to[next->id] = new SuperArc(next, node, arc));
+            }
             for (Arc *arc : node->incomings)
-                if (arc->next->super != super_node)
-                    super_node->incomings.push_back(new SuperArc(arc->next->super, node, arc));
+            {
+                SuperNode *next = arc->next->super;
+                if (next == super_node)
+                    continue;
+                if (arc_from[next->id] != nullptr && arc_from[next->id]->exit->super == super_node)
+                    arc_from[next->id]->portals.push_back({node, arc});
+                else
+                    super_node->incomings.push_back(arc_from[next->id] = new SuperArc(next, node, arc));
+            }
         }
+        if (super_node->internals.size() == 1) // its legs are all empty
+            continue;
+        for (Node *node : super_node->internals)
+        {
+            super_node->locals.push_back(new Node(node->local, node->position));
+            super_node->locals.back()->super = super_node, super_node->locals.back()->local = node->local;
+        }
+        for (Node *node : super_node->internals)
+        {
+            Node *local = super_node->locals[node->local];
+            for (Arc *arc : node->outgoings)
+                if (arc->next->super == super_node)
+                    local->outgoings.push_back(new Arc(super_node->locals[arc->next->local], arc->move));
+            for (Arc *arc : node->incomings)
+                if (arc->next->super == super_node)
+                    local->incomings.push_back(new Arc(super_node->locals[arc->next->local], arc->move));
+        }
+    }
+    delete[] arc_to;
+    delete[] arc_from;
+    profile_world();
 }
 
 void Lattice::tarjan_dfs(Node *u, int visit_time[], int low_link[], bool is_on_stack[],
-                         std::stack<Node *> &stack, int &current_time, id_t &id) noexcept
+                         _2Ls::BoxStack<Node *, false> &stack, int &current_time, id_t &id) noexcept
 {
     visit_time[u->id] = low_link[u->id] = ++current_time;
     stack.push(u);
@@ -547,8 +1412,7 @@ void Lattice::tarjan_dfs(Node *u, int visit_time[], int low_link[], bool is_on_s
         Node *current;
         do
         {
-            current = stack.top();
-            stack.pop();
+            current = stack.extract();
             is_on_stack[current->id] = false;
             current->super = component;
             component->internals.push_back(current);
@@ -557,630 +1421,2105 @@ void Lattice::tarjan_dfs(Node *u, int visit_time[], int low_link[], bool is_on_s
     }
 }
 
+// the throwing API reports every status other than FOUND as the matching exception
+static void throw_on_failure(const Lattice::SearchStatus &status, const TripPlan &trip_plan,
+                             const Lattice::SearchMode &search_mode,
+                             const Lattice::SearchMode &sub_search_mode)
+{
+    switch (status)
+    {
+    case Lattice::FOUND:
+        return;
+    case Lattice::UNTRAVERSABLE:
+        throw Untraversable(trip_plan.source, trip_plan.target);
+    case Lattice::INVALID_SOURCE:
+        throw InvalidSource(trip_plan.source);
+    case Lattice::INVALID_TARGET:
+        throw InvalidTarget(trip_plan.target);
+    case Lattice::INVALID_SEARCH_MODE:
+        throw InvalidSearchMode(search_mode);
+    case Lattice::INVALID_SUB_SEARCH_MODE:
+        throw InvalidSearchMode(sub_search_mode);
+    }
+}
+
 Lattice::Route Lattice::search(const TripPlan &trip_plan, const SearchMode &search_mode) const
+{
+    Route route;
+    throw_on_failure(try_search(trip_plan, search_mode, route), trip_plan, search_mode, search_mode);
+    return route;
+}
+
+Lattice::Route Lattice::super_search(const TripPlan &trip_plan,
+                                     const SearchMode &super_search_mode,
+                                     const SearchMode &sub_search_mode) const
+{
+    Route route;
+    throw_on_failure(try_super_search(trip_plan, super_search_mode, sub_search_mode, route),
+                     trip_plan, super_search_mode, sub_search_mode);
+    return route;
+}
+
+size_t Lattice::search(const TripPlan &trip_plan, const SearchMode &search_mode, PackedRoute &route) const
+{
+    throw_on_failure(try_search(trip_plan, search_mode, route), trip_plan, search_mode, search_mode);
+    return route.size();
+}
+
+size_t Lattice::super_search(const TripPlan &trip_plan,
+                             const SearchMode &super_search_mode,
+                             const SearchMode &sub_search_mode,
+                             PackedRoute &route) const
+{
+    throw_on_failure(try_super_search(trip_plan, super_search_mode, sub_search_mode, route),
+                     trip_plan, super_search_mode, sub_search_mode);
+    return route.size();
+}
+
+Lattice::SearchStatus Lattice::try_search(const TripPlan &trip_plan, const SearchMode &search_mode,
+                                          Route &route) const
+{
+    Workspace workspace(*this);
+    return try_search_as(trip_plan, search_mode, route, workspace);
+}
+
+Lattice::SearchStatus Lattice::try_search(const TripPlan &trip_plan, const SearchMode &search_mode,
+                                          PackedRoute &route) const
+{
+    Workspace workspace(*this);
+    return try_search_as(trip_plan, search_mode, route, workspace);
+}
+
+Lattice::SearchStatus Lattice::try_super_search(const TripPlan &trip_plan,
+                                                const SearchMode &super_search_mode,
+                                                const SearchMode &sub_search_mode,
+                                                Route &route) const
+{
+    Workspace workspace(*this);
+    return try_super_search_as(trip_plan, super_search_mode, sub_search_mode, route, workspace);
+}
+
+Lattice::SearchStatus Lattice::try_super_search(const TripPlan &trip_plan,
+                                                const SearchMode &super_search_mode,
+                                                const SearchMode &sub_search_mode,
+                                                PackedRoute &route) const
+{
+    Workspace workspace(*this);
+    return try_super_search_as(trip_plan, super_search_mode, sub_search_mode, route, workspace);
+}
+
+template <typename R>
+Lattice::SearchStatus Lattice::try_search_as(const TripPlan &trip_plan, const SearchMode &search_mode,
+                                             R &route, Workspace &workspace) const
+{
+    auto source = graph.find(trip_plan.source); // check source validity
+    if (source == graph.end())
+        return INVALID_SOURCE;
+
+    auto target = graph.find(trip_plan.target); // check target validity
+    if (target == graph.end())
+        return INVALID_TARGET;
+
+    SearchMode mode = search_mode == AUTO ? choose_mode(source->second, target->second) : search_mode;
+    AlgorithmOf<R> algorithm = get_algorithm<R>(mode);
+    if (algorithm == nullptr)
+        return INVALID_SEARCH_MODE;
+
+    route.clear();
+    RouteCache::Key key{source->second->id, target->second->id, mode, RouteCache::node_search};
+    bool found;
+    if (routes != nullptr && routes->enabled() && routes->find(key, found, route))
+        return found ? FOUND : UNTRAVERSABLE;
+    if (search_mode == AUTO && !congraph.empty() && source->second->super != target->second->super &&
+        !reachable(source->second, target->second)) // the condensation settles it without a search
+        return UNTRAVERSABLE;
+
+    // a BFS tree retraces to the same route bfs finds
+    if (mode == BFS && source_trees != nullptr && source_trees->enabled())
+    {
+        bool hot = false;
+        std::shared_ptr<const SourceTree> tree = source_trees->find(source->second->id, hot);
+        if (hot)
+        {
+            try
+            {
+                tree = source_trees->insert(build_source_tree(source->second));
+            }
+            catch (...)
+            {
+                source_trees->abandon(source->second->id);
+                throw;
+            }
+        }
+        if (tree != nullptr)
+            found = retrace_source_tree(*tree, target->second, route);
+        else
+            found = (this->*algorithm)(source->second, target->second, route, workspace);
+    }
+    else
+        found = (this->*algorithm)(source->second, target->second, route, workspace);
+    if (routes != nullptr && routes->enabled())
+        routes->insert(key, found, route);
+    return found ? FOUND : UNTRAVERSABLE;
+}
+
+template <typename R>
+Lattice::SearchStatus Lattice::try_super_search_as(const TripPlan &trip_plan,
+                                                   const SearchMode &super_search_mode,
+                                                   const SearchMode &sub_search_mode,
+                                                   R &route, Workspace &workspace) const
+{
+    auto source = graph.find(trip_plan.source); // check source validity
+    if (source == graph.end())
+        return INVALID_SOURCE;
+
+    auto target = graph.find(trip_plan.target); // check target validity
+    if (target == graph.end())
+        return INVALID_TARGET;
+
+    // AUTO takes the mode it would pick for the whole trip as the super mode, and the one it would
+    // pick for a trip as long inside one component for the legs, which never leave theirs
+    size_t query = query_class(source->second, target->second);
+    SearchMode super_mode = super_search_mode == AUTO ? auto_modes[query] : super_search_mode;
+    SuperAlgorithmOf<R> super_algorithm = get_super_algorithm<R>(super_mode);
+    if (super_algorithm == nullptr)
+        return INVALID_SEARCH_MODE;
+
+    SearchMode sub_mode = sub_search_mode == AUTO ? auto_modes[query % distance_classes] : sub_search_mode;
+    AlgorithmOf<R> algorithm = get_algorithm<R>(sub_mode);
+    if (algorithm == nullptr)
+        return INVALID_SUB_SEARCH_MODE;
+
+    route.clear();
+    bool is_super = source->second->super != target->second->super;
+    SearchMode plain_mode = sub_mode; // of the search run when the trip stays in one component
+    if (super_search_mode == AUTO && is_super && !auto_goes_super) // a plain search of the trip instead
+    {
+        if (!reachable(source->second, target->second)) // the condensation settles it without a search
+            return UNTRAVERSABLE;
+        plain_mode = super_mode, algorithm = get_algorithm<R>(super_mode), is_super = false;
+    }
+    // keyed on the modes actually run, so a plain search shares its entry with try_search's
+    RouteCache::Key key = is_super ? RouteCache::Key{source->second->id, target->second->id, super_mode, sub_mode}
+                                   : RouteCache::Key{source->second->id, target->second->id, plain_mode,
+                                                     RouteCache::node_search};
+    bool found;
+    if (routes != nullptr && routes->enabled() && routes->find(key, found, route))
+        return found ? FOUND : UNTRAVERSABLE;
+
+    if (is_super)
+        found = (this->*super_algorithm)(source->second, target->second, sub_mode, route, workspace);
+    else
+        found = (this->*algorithm)(source->second, target->second, route, workspace);
+    if (routes != nullptr && routes->enabled())
+        routes->insert(key, found, route);
+    return found ? FOUND : UNTRAVERSABLE;
+}
+
+void Lattice::search_batch(const TripPlan trip_plans[], const size_t &count, const SearchMode &search_mode,
+                           SearchStatus statuses[], Route routes[], const size_t &threads) const
+{
+    search_batch_as(trip_plans, count, search_mode, statuses, routes, threads);
+}
+
+void Lattice::search_batch(const TripPlan trip_plans[], const size_t &count, const SearchMode &search_mode,
+                           SearchStatus statuses[], PackedRoute routes[], const size_t &threads) const
+{
+    search_batch_as(trip_plans, count, search_mode, statuses, routes, threads);
+}
+
+template <typename R>
+void Lattice::search_batch_as(const TripPlan trip_plans[], const size_t &count, const SearchMode &search_mode,
+                              SearchStatus statuses[], R routes[], size_t threads) const
+{
+    parallel_for(*this, tasks(), count, 32, threads, [&](const size_t &i, Workspace &workspace) -> void
+                 { statuses[i] = try_search_as(trip_plans[i], search_mode, routes[i], workspace); });
+}
+
+// Row i holds the distances from sources[i], unreachable wherever statuses says other than FOUND.
+// As in routes_from, an invalid source fills its row with INVALID_SOURCE and an invalid target
+// marks its column INVALID_TARGET, while every other pair is still answered.
+void Lattice::distance_matrix(const Coordinate sources[], const size_t &source_count,
+                              const Coordinate targets[], const size_t &target_count,
+                              SearchStatus statuses[], size_t distances[], const size_t &threads) const
+{
+    std::vector<Node *> source_nodes(source_count), target_nodes(target_count);
+    for (size_t i = 0; i < source_count; ++i)
+    {
+        auto found = graph.find(sources[i]); // check source validity
+        source_nodes[i] = found == graph.end() ? nullptr : found->second;
+    }
+    std::vector<bool> is_target(nodes.size());
+    size_t target_node_count = 0;
+    for (size_t j = 0; j < target_count; ++j)
+    {
+        auto found = graph.find(targets[j]); // check target validity
+        target_nodes[j] = found == graph.end() ? nullptr : found->second;
+        if (target_nodes[j] != nullptr && !is_target[target_nodes[j]->id])
+            is_target[target_nodes[j]->id] = true, ++target_node_count;
+    }
+
+    auto expand = [&](const size_t &i, Workspace &workspace) -> void
+    {
+        MetaData &meta_data_f = workspace.meta_data_f;
+        SearchStatus *status = statuses + i * target_count;
+        size_t *row = distances + i * target_count;
+        std::fill(row, row + target_count, unreachable);
+        if (source_nodes[i] == nullptr)
+        {
+            std::fill(status, status + target_count, INVALID_SOURCE);
+            return;
+        }
+        expand_to_targets(source_nodes[i], is_target, target_node_count, workspace);
+        for (size_t j = 0; j < target_count; ++j)
+            if (target_nodes[j] == nullptr)
+                status[j] = INVALID_TARGET;
+            else if (target_nodes[j] == source_nodes[i])
+                status[j] = FOUND, row[j] = 0;
+            else if (meta_data_f.visited(target_nodes[j]))
+                status[j] = FOUND, row[j] = meta_data_f.retrace_length(target_nodes[j]);
+            else
+                status[j] = UNTRAVERSABLE;
+    };
+    parallel_for(*this, tasks(), source_count, 1, threads, expand);
+}
+
+void Lattice::routes_from(const Coordinate &source, const Coordinate targets[], const size_t &target_count,
+                          SearchStatus statuses[], Route routes[]) const
+{
+    routes_from_as(source, targets, target_count, statuses, routes);
+}
+
+void Lattice::routes_from(const Coordinate &source, const Coordinate targets[], const size_t &target_count,
+                          SearchStatus statuses[], PackedRoute routes[]) const
+{
+    routes_from_as(source, targets, target_count, statuses, routes);
+}
+
+template <typename R>
+void Lattice::routes_from_as(const Coordinate &source, const Coordinate targets[], const size_t &target_count,
+                             SearchStatus statuses[], R routes[]) const
+{
+    auto source_node = graph.find(source); // check source validity
+    if (source_node == graph.end())
+    {
+        std::fill(statuses, statuses + target_count, INVALID_SOURCE);
+        return;
+    }
+    std::vector<Node *> target_nodes(target_count);
+    std::vector<bool> is_target(nodes.size());
+    size_t target_node_count = 0;
+    for (size_t j = 0; j < target_count; ++j)
+    {
+        auto found = graph.find(targets[j]); // check target validity
+        target_nodes[j] = found == graph.end() ? nullptr : found->second;
+        if (target_nodes[j] != nullptr && !is_target[target_nodes[j]->id])
+            is_target[target_nodes[j]->id] = true, ++target_node_count;
+    }
+
+    Workspace workspace(*this);
+    MetaData &meta_data_f = workspace.meta_data_f;
+    expand_to_targets(source_node->second, is_target, target_node_count, workspace);
+    for (size_t j = 0; j < target_count; ++j)
+    {
+        routes[j].clear();
+        if (target_nodes[j] == nullptr)
+            statuses[j] = INVALID_TARGET;
+        else if (target_nodes[j] == source_node->second)
+            statuses[j] = FOUND;
+        else if (!meta_data_f.visited(target_nodes[j]))
+            statuses[j] = UNTRAVERSABLE;
+        else
+        {
+            meta_data_f.retrace_route(target_nodes[j], routes[j]);
+            reverse_route(routes[j], 0);
+            statuses[j] = FOUND;
+        }
+    }
+}
+
+// Expands source breadth first until every flagged target has been reached, so the forward
+// meta data then holds a shortest route to each of them. Returns false if some never are.
+bool Lattice::expand_to_targets(Node *source, const std::vector<bool> &is_target, size_t pending,
+                                Workspace &workspace) const
+{
+    MetaData &meta_data_f = workspace.meta_data_f;
+    meta_data_f.configure(source, source, MetaData::BFS_F);
+    if (is_target[source->id])
+        --pending;
+    for (Node *current_f = source; pending != 0;)
+    {
+        current_f = meta_data_f.extract_next(current_f);
+        if (current_f == nullptr)
+            return false;
+        if (current_f != source && is_target[current_f->id])
+            --pending;
+    }
+    return true;
+}
+
+Lattice::Route Lattice::search_nearest(const Coordinate &source, const Coordinate targets[],
+                                       const size_t &target_count, const SearchMode &search_mode,
+                                       size_t &nearest) const
+{
+    Route route;
+    SearchStatus status = try_search_nearest(source, targets, target_count, search_mode, nearest, route);
+    for (size_t j = 0; status == INVALID_TARGET && j < target_count; ++j)
+        if (graph.find(targets[j]) == graph.end())
+            throw InvalidTarget(targets[j]);
+    throw_on_failure(status, TripPlan(source, target_count ? targets[0] : source), search_mode, search_mode);
+    return route;
+}
+
+Lattice::SearchStatus Lattice::try_search_nearest(const Coordinate &source, const Coordinate targets[],
+                                                  const size_t &target_count, const SearchMode &search_mode,
+                                                  size_t &nearest, Route &route) const
+{
+    return try_search_nearest_as(source, targets, target_count, search_mode, nearest, route);
+}
+
+Lattice::SearchStatus Lattice::try_search_nearest(const Coordinate &source, const Coordinate targets[],
+                                                  const size_t &target_count, const SearchMode &search_mode,
+                                                  size_t &nearest, PackedRoute &route) const
+{
+    return try_search_nearest_as(source, targets, target_count, search_mode, nearest, route);
+}
+
+// One expansion finds the nearest of all targets, which are flagged in a bitset by node id. BFS
+// and A* (aiming at the nearest target) stop at the first target they settle, while the
+// bidirectional modes grow a second search from every target at once and stop where they meet.
+// Other modes are INVALID_SEARCH_MODE.
+template <typename R>
+Lattice::SearchStatus Lattice::try_search_nearest_as(const Coordinate &source, const Coordinate targets[],
+                                                     const size_t &target_count,
+                                                     const SearchMode &search_mode,
+                                                     size_t &nearest, R &route) const
+{
+    auto source_node = graph.find(source); // check source validity
+    if (source_node == graph.end())
+        return INVALID_SOURCE;
+    std::vector<Node *> target_nodes(target_count), goals; // goals lists each target node once
+    std::vector<bool> is_target(nodes.size());
+    for (size_t j = 0; j < target_count; ++j)
+    {
+        auto found = graph.find(targets[j]); // check target validity
+        if (found == graph.end())
+            return INVALID_TARGET;
+        target_nodes[j] = found->second;
+        if (!is_target[found->second->id])
+            goals.push_back(found->second);
+        is_target[found->second->id] = true;
+    }
+
+    Workspace workspace(*this);
+    Node *reached = nullptr;
+    route.clear();
+    switch (search_mode)
+    {
+    case BFS:
+    case A_STAR:
+        reached = nearest_target(source_node->second, goals, is_target, search_mode, route, workspace);
+        break;
+    case BIDIRECTIONAL_BFS:
+        reached = bidirectional_nearest_target(source_node->second, goals, is_target, BFS, route,
+                                               workspace);
+        break;
+    case BIDIRECTIONAL_A_STAR:
+        reached = bidirectional_nearest_target(source_node->second, goals, is_target, A_STAR, route,
+                                               workspace);
+        break;
+    default:
+        return INVALID_SEARCH_MODE;
+    }
+    if (reached == nullptr)
+        return UNTRAVERSABLE;
+    nearest = std::find(target_nodes.begin(), target_nodes.end(), reached) - target_nodes.begin();
+    return FOUND;
+}
+
+template <typename R>
+Lattice::Node *Lattice::nearest_target(Node *source, const std::vector<Node *> &targets,
+                                       const std::vector<bool> &is_target, const SearchMode &search_mode,
+                                       R &route, Workspace &workspace) const
+{
+    if (targets.empty())
+        return nullptr;
+    if (is_target[source->id]) // trivial case
+        return source;
+
+    MetaData &meta_data_f = workspace.meta_data_f;
+    meta_data_f.configure(source, targets.front(), search_mode == A_STAR ? MetaData::ASTAR_F : MetaData::BFS_F);
+    meta_data_f.aim(targets);
+
+    for (Node *current_f = source;;)
+    {
+        current_f = meta_data_f.extract_next(current_f);
+        if (current_f == nullptr)
+            return nullptr;
+        if (is_target[current_f->id])
+        {
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            return current_f;
+        }
+    }
+}
+
+template <typename R>
+Lattice::Node *Lattice::bidirectional_nearest_target(Node *source, const std::vector<Node *> &targets,
+                                                     const std::vector<bool> &is_target,
+                                                     const SearchMode &search_mode, R &route,
+                                                     Workspace &workspace) const
+{
+    if (targets.empty())
+        return nullptr;
+    if (is_target[source->id]) // trivial case
+        return source;
+
+    MetaData &meta_data_f = workspace.meta_data_f;
+    meta_data_f.configure(source, targets.front(), search_mode == A_STAR ? MetaData::ASTAR_F : MetaData::BFS_F);
+    meta_data_f.aim(targets);
+    MetaData &meta_data_b = workspace.meta_data_b;
+    meta_data_b.configure(targets.front(), source, search_mode == A_STAR ? MetaData::ASTAR_B : MetaData::BFS_B);
+    meta_data_b.seed(targets, is_target);
+
+    for (Node *current_f = source, *current_b = nullptr;;)
+    {
+        current_f = meta_data_f.extract_next(current_f);
+        if (current_f == nullptr)
+            return nullptr;
+        if (meta_data_b.visited(current_f))
+        {
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            return meta_data_b.retrace_route(current_f, route);
+        }
+        current_b = current_b == nullptr ? meta_data_b.extract_seed() : meta_data_b.extract_next(current_b);
+        if (current_b == nullptr)
+            return nullptr;
+        if (meta_data_f.visited(current_b))
+        {
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_b, route);
+            reverse_route(route, first);
+            return meta_data_b.retrace_route(current_b, route);
+        }
+    }
+}
+
+std::shared_ptr<const Lattice::FlowField> Lattice::build_flow_field(const Coordinate &target) const
+{
+    auto found = graph.find(target); // check target validity
+    if (found == graph.end())
+        throw InvalidTarget(target);
+    std::shared_ptr<const FlowField> field = flow_fields->find(found->second->id);
+    if (field != nullptr)
+        return field;
+
+    // breadth first over incomings, so each node's move leads one step closer to target
+    std::shared_ptr<FlowField> built = std::make_shared<FlowField>(found->second->id, nodes.size());
+    _2Ls::BoxQueue<Node *, false> open_set;
+    built->distances[found->second->id] = 0;
+    open_set.push(found->second);
+    while (!open_set.empty())
+    {
+        Node *current = open_set.extract();
+        for (Arc *arc : current->incomings)
+        {
+            if (built->distances[arc->next->id] != FlowField::unreached)
+                continue;
+            built->distances[arc->next->id] = built->distances[current->id] + 1;
+            built->set_move(arc->next->id, arc->move);
+            open_set.push(arc->next);
+        }
+    }
+    return flow_fields->insert(built);
+}
+
+void Lattice::set_flow_field_budget(const size_t &bytes)
+{
+    if (flow_fields != nullptr)
+        flow_fields->set_budget(bytes);
+}
+
+size_t Lattice::flow_distance(const FlowField &field, const Coordinate &source) const
+{
+    auto found = graph.find(source); // check source validity
+    if (found == graph.end())
+        throw InvalidSource(source);
+    uint32_t distance = field.distances[found->second->id];
+    return distance == FlowField::unreached ? unreachable : distance;
+}
+
+Lattice::SearchStatus Lattice::try_follow_flow_field(const FlowField &field, const Coordinate &source,
+                                                     Route &route) const
+{
+    return try_follow_flow_field_as(field, source, route);
+}
+
+Lattice::SearchStatus Lattice::try_follow_flow_field(const FlowField &field, const Coordinate &source,
+                                                     PackedRoute &route) const
+{
+    return try_follow_flow_field_as(field, source, route);
+}
+
+Lattice::SearchStatus Lattice::try_flow_search(const TripPlan &trip_plan, Route &route) const
 {
     if (graph.find(trip_plan.source) == graph.end()) // check source validity
-        throw InvalidSource(trip_plan.source);
-    Node *source = graph.at(trip_plan.source);
+        return INVALID_SOURCE;
+    if (graph.find(trip_plan.target) == graph.end()) // check target validity
+        return INVALID_TARGET;
+    return try_follow_flow_field_as(*build_flow_field(trip_plan.target), trip_plan.source, route);
+}
 
+Lattice::SearchStatus Lattice::try_flow_search(const TripPlan &trip_plan, PackedRoute &route) const
+{
+    if (graph.find(trip_plan.source) == graph.end()) // check source validity
+        return INVALID_SOURCE;
     if (graph.find(trip_plan.target) == graph.end()) // check target validity
+        return INVALID_TARGET;
+    return try_follow_flow_field_as(*build_flow_field(trip_plan.target), trip_plan.source, route);
+}
+
+// Each step must take the stored move to a node one closer to target; a field that does not lead
+// there, such as one built on another lattice, is UNTRAVERSABLE rather than followed forever.
+template <typename R>
+Lattice::SearchStatus Lattice::try_follow_flow_field_as(const FlowField &field, const Coordinate &source,
+                                                        R &route) const
+{
+    auto found = graph.find(source); // check source validity
+    if (found == graph.end())
+        return INVALID_SOURCE;
+    route.clear();
+    Node *current = found->second;
+    if (field.node_count != nodes.size() || field.distances[current->id] == FlowField::unreached)
+        return UNTRAVERSABLE;
+    while (field.distances[current->id] != 0)
+    {
+        Move move = field.move(current->id);
+        Node *next = nullptr;
+        for (Arc *arc : current->outgoings)
+            if (arc->move == move && field.distances[arc->next->id] + 1 == field.distances[current->id])
+            {
+                next = arc->next;
+                break;
+            }
+        if (next == nullptr)
+        {
+            route.clear();
+            return UNTRAVERSABLE;
+        }
+        route.push_back(move);
+        current = next;
+    }
+    return FOUND;
+}
+
+// the whole breadth first expansion bfs would run, in the same order, so parents match
+std::shared_ptr<const Lattice::SourceTree> Lattice::build_source_tree(Node *source) const
+{
+    std::shared_ptr<SourceTree> tree = std::make_shared<SourceTree>(source->id, nodes.size());
+    _2Ls::BoxQueue<Node *, false> open_set;
+    open_set.push(source);
+    while (!open_set.empty())
+    {
+        Node *current = open_set.extract();
+        for (Arc *arc : current->outgoings)
+        {
+            if (arc->next == source || tree->is_reached(arc->next->id))
+                continue;
+            tree->reach(arc->next, current, arc->move);
+            open_set.push(arc->next);
+        }
+    }
+    return tree;
+}
+
+template <typename R>
+bool Lattice::retrace_source_tree(const SourceTree &tree, Node *target, R &route) const
+{
+    if (target->id == tree.source) // trivial case
+        return true;
+    if (!tree.is_reached(target->id))
+        return false;
+    size_t first = route.size();
+    for (Node *n = target; n->id != tree.source; n = tree.last(n))
+        route.push_back(tree.move(n->id));
+    reverse_route(route, first);
+    return true;
+}
+
+void Lattice::set_source_tree_budget(const size_t &bytes)
+{
+    if (source_trees != nullptr)
+        source_trees->set_budget(bytes);
+}
+
+size_t Lattice::distance(const TripPlan &trip_plan, const SearchMode &search_mode) const
+{
+    auto source = graph.find(trip_plan.source); // check source validity
+    if (source == graph.end())
+        throw InvalidSource(trip_plan.source);
+
+    auto target = graph.find(trip_plan.target); // check target validity
+    if (target == graph.end())
         throw InvalidTarget(trip_plan.target);
-    Node *target = graph.at(trip_plan.target);
 
-    Algorithm algorithm = get_algorithm(search_mode);
+    AlgorithmOf<RouteLength> algorithm = get_algorithm<RouteLength>(
+        search_mode == AUTO ? choose_mode(source->second, target->second) : search_mode);
     if (algorithm == nullptr)
         throw InvalidSearchMode(search_mode);
 
-    try
+    // the condensation rules most misses out cheaply; without it reachable() would search twice
+    if (!congraph.empty() && !reachable(source->second, target->second))
+        return unreachable;
+    Workspace workspace(*this);
+    RouteLength length;
+    return (this->*algorithm)(source->second, target->second, length, workspace) ? length.size() : unreachable;
+}
+
+bool Lattice::reachable(const TripPlan &trip_plan) const
+{
+    auto source = graph.find(trip_plan.source); // check source validity
+    if (source == graph.end())
+        throw InvalidSource(trip_plan.source);
+
+    auto target = graph.find(trip_plan.target); // check target validity
+    if (target == graph.end())
+        throw InvalidTarget(trip_plan.target);
+
+    return reachable(source->second, target->second);
+}
+
+// Tarjan numbers components in reverse topological order, so every component reachable from
+// another has a smaller id and the search never needs to enter one numbered below the target
+bool Lattice::reachable(Node *source, Node *target) const
+{
+    if (source == target)
+        return true;
+    if (congraph.empty()) // not condensed, so flood the nodes themselves
+    {
+        Workspace workspace(*this);
+        RouteLength length;
+        return bfs(source, target, length, workspace);
+    }
+    SuperNode *super_source = source->super, *super_target = target->super;
+    if (super_source == super_target)
+        return true;
+    if (super_source->id < super_target->id)
+        return false;
+    bool *is_visited = new bool[congraph.size()]();
+    _2Ls::BoxStack<SuperNode *, false> open_set(congraph.size());
+    open_set.push(super_source);
+    is_visited[super_source->id] = true;
+    bool found = false;
+    while (!found && !open_set.empty())
+    {
+        SuperNode *current = open_set.extract();
+        for (SuperArc *super_arc : current->outgoings)
+        {
+            SuperNode *next = super_arc->next;
+            if (next == super_target)
+            {
+                found = true;
+                break;
+            }
+            if (is_visited[next->id] || next->id < super_target->id)
+                continue;
+            is_visited[next->id] = true;
+            open_set.push(next);
+        }
+    }
+    delete[] is_visited;
+    return found;
+}
+
+std::vector<bool> Lattice::reachable_within(const Coordinate &source, const size_t &k, const size_t &threads) const
+{
+    auto found = graph.find(source); // check source validity
+    if (found == graph.end())
+        throw InvalidSource(source);
+    return flood(found->second, k, threads);
+}
+
+std::vector<bool> Lattice::reachable_region(const Coordinate &source, const size_t &threads) const
+{
+    return reachable_within(source, unreachable, threads);
+}
+
+std::vector<Coordinate> Lattice::region_positions(const std::vector<bool> &region) const
+{
+    std::vector<Coordinate> positions;
+    for (size_t id = 0; id < region.size() && id < nodes.size(); ++id)
+        if (region[id])
+            positions.push_back(nodes[id]->position);
+    return positions;
+}
+
+size_t Lattice::node_id(const Coordinate &position) const
+{
+    auto found = graph.find(position);
+    if (found == graph.end())
+        throw InvalidSource(position);
+    return found->second->id;
+}
+
+std::vector<bool> Lattice::flood(Node *source, const size_t &k, size_t threads) const
+{
+    Levels levels;
+    levels.reset(nodes.size(), false);
+    expand_levels(source, nullptr, k, threads, levels, nullptr);
+    std::vector<bool> region(nodes.size());
+    for (size_t id = 0; id < nodes.size(); ++id)
+        region[id] = levels.is_reached(id);
+    return region;
+}
+
+// Level-synchronous, direction-optimizing BFS out to k moves, or until target is reached. Each
+// node is claimed by setting its bit in the levels' reached bitset, and last/move, when kept,
+// take its parent and arrival move from whichever thread claims it.
+//
+// Small frontiers expand top-down over outgoings. Once the frontier's arcs outnumber a fraction
+// of the arcs still unexplored, the level is run bottom-up instead: every unreached node scans
+// its incomings against a bitmap of the frontier and stops at the first hit, which is far less
+// work when most of the world is one level away. The search drops back to top-down when the
+// frontier shrinks again. Levels big enough to be worth it are split across threads.
+void Lattice::expand_levels(Node *source, Node *target, const size_t &k, size_t threads, Levels &levels,
+                            const std::atomic<bool> *stop) const
+{
+    static constexpr size_t parallel_frontier = 1 << 12, grain = 1 << 8, bottom_up_grain = 1 << 12;
+    static constexpr size_t alpha = 14, beta = 24; // switching thresholds from Beamer et al.
+    _2Ls::TaskScheduler &scheduler = tasks();
+    if (threads == 0 || threads > scheduler.thread_count())
+        threads = scheduler.thread_count();
+    std::atomic<uint64_t> *reached = levels.reached;
+    Node **last = levels.last;
+    Move *move = levels.move;
+    std::vector<Node *> &frontier = levels.frontier, &next = levels.next;
+    std::vector<uint64_t> &in_frontier = levels.in_frontier;
+    std::vector<std::vector<Node *>> &claimed = levels.claimed;
+    std::vector<size_t> &claimed_arcs = levels.claimed_arcs;
+    auto is_reached = [&levels](const size_t &id) -> bool
+    { return levels.is_reached(id); };
+    auto claim = [reached](const Node *n) -> bool
+    {
+        uint64_t bit = uint64_t(1) << (n->id & 63);
+        std::atomic<uint64_t> &word = reached[n->id >> 6];
+        return !(word.load(std::memory_order_relaxed) & bit) && !(word.fetch_or(bit, std::memory_order_relaxed) & bit);
+    };
+    auto top_down = [&](Node *current, std::vector<Node *> &next) -> size_t
     {
-        return (this->*algorithm)(source, target);
+        size_t arc_count = 0;
+        for (Arc *arc : current->outgoings)
+            if (claim(arc->next))
+            {
+                if (last != nullptr)
+                    last[arc->next->id] = current, move[arc->next->id] = arc->move;
+                next.push_back(arc->next);
+                arc_count += arc->next->outgoings.size();
+            }
+        return arc_count;
+    };
+    auto bottom_up = [&](Node *current, std::vector<Node *> &next) -> size_t
+    {
+        if (is_reached(current->id))
+            return 0;
+        for (Arc *arc : current->incomings)
+            if (in_frontier[arc->next->id >> 6] >> (arc->next->id & 63) & 1)
+            {
+                claim(current);
+                if (last != nullptr)
+                    last[current->id] = arc->next, move[current->id] = arc->move;
+                next.push_back(current);
+                return current->outgoings.size();
+            }
+        return 0;
+    };
+
+    size_t unexplored_arcs = 0;
+    for (Node *n : nodes)
+        unexplored_arcs += n->outgoings.size();
+    frontier.assign(1, source);
+    claimed.resize(threads);
+    claimed_arcs.assign(threads, 0);
+    for (std::vector<Node *> &own : claimed)
+        own.clear();
+    size_t frontier_arcs = source->outgoings.size();
+    bool is_bottom_up = false;
+    claim(source);
+    for (size_t depth = 0; depth < k && !frontier.empty(); ++depth)
+    {
+        if ((target != nullptr && is_reached(target->id)) || (stop != nullptr && stop->load(std::memory_order_relaxed)))
+            return;
+        unexplored_arcs -= std::min(unexplored_arcs, frontier_arcs);
+        if (!is_bottom_up && frontier_arcs > unexplored_arcs / alpha)
+            is_bottom_up = true;
+        else if (is_bottom_up && frontier.size() < nodes.size() / beta)
+            is_bottom_up = false;
+
+        next.clear();
+        frontier_arcs = 0;
+        if (is_bottom_up)
+        {
+            in_frontier.assign((nodes.size() + 63) / 64, 0);
+            for (Node *n : frontier)
+                in_frontier[n->id >> 6] |= uint64_t(1) << (n->id & 63);
+            if (threads == 1)
+                for (Node *n : nodes)
+                    frontier_arcs += bottom_up(n, next);
+            else
+                scheduler.parallel_chunks(nodes.size(), bottom_up_grain, threads, [&](const size_t &first, const size_t &last, const size_t &worker)
+                                          {
+                                              for (size_t id = first; id < last; ++id)
+                                                  claimed_arcs[worker] += bottom_up(nodes[id], claimed[worker]); });
+        }
+        else if (threads == 1 || frontier.size() < parallel_frontier)
+        {
+            for (Node *current : frontier)
+                frontier_arcs += top_down(current, next);
+        }
+        else
+            scheduler.parallel_chunks(frontier.size(), grain, threads, [&](const size_t &first, const size_t &last, const size_t &worker)
+                                      {
+                                          for (size_t i = first; i < last; ++i)
+                                              claimed_arcs[worker] += top_down(frontier[i], claimed[worker]); });
+        for (size_t worker = 0; worker < threads; ++worker)
+        {
+            next.insert(next.end(), claimed[worker].begin(), claimed[worker].end());
+            frontier_arcs += claimed_arcs[worker];
+            claimed[worker].clear(), claimed_arcs[worker] = 0;
+        }
+        frontier.swap(next);
     }
-    catch (const std::exception &e)
+}
+
+Lattice::Route Lattice::search_race(const TripPlan &trip_plan, const std::vector<SearchMode> &search_modes,
+                                    SearchMode &winner) const
+{
+    Route route;
+    SearchStatus status = try_search_race(trip_plan, search_modes, winner, route);
+    throw_on_failure(status, trip_plan, winner, winner);
+    return route;
+}
+
+Lattice::SearchStatus Lattice::try_search_race(const TripPlan &trip_plan, const std::vector<SearchMode> &search_modes,
+                                               SearchMode &winner, Route &route) const
+{
+    return try_search_race_as(trip_plan, search_modes, winner, route);
+}
+
+Lattice::SearchStatus Lattice::try_search_race(const TripPlan &trip_plan, const std::vector<SearchMode> &search_modes,
+                                               SearchMode &winner, PackedRoute &route) const
+{
+    return try_search_race_as(trip_plan, search_modes, winner, route);
+}
+
+// Every mode runs as its own task on its own workspace. The first to finish claims the win, keeps
+// its answer, found or not, since every mode searches exhaustively, and raises the stop flag the
+// others poll between expansions, so a mode that only gets a thread once the race is over returns
+// straight away. An invalid mode is reported through winner, and an empty race as the invalid
+// mode -1.
+template <typename R>
+Lattice::SearchStatus Lattice::try_search_race_as(const TripPlan &trip_plan,
+                                                  const std::vector<SearchMode> &search_modes,
+                                                  SearchMode &winner, R &route) const
+{
+    auto source = graph.find(trip_plan.source); // check source validity
+    if (source == graph.end())
+        return INVALID_SOURCE;
+
+    auto target = graph.find(trip_plan.target); // check target validity
+    if (target == graph.end())
+        return INVALID_TARGET;
+
+    std::vector<AlgorithmOf<R>> algorithms;
+    for (const SearchMode &search_mode : search_modes)
     {
-        throw;
+        algorithms.push_back(get_algorithm<R>(search_mode));
+        if (algorithms.back() == nullptr)
+            return winner = search_mode, INVALID_SEARCH_MODE;
     }
+    if (algorithms.empty())
+        return winner = SearchMode(-1), INVALID_SEARCH_MODE;
+
+    std::atomic<bool> stop(false);
+    std::atomic<size_t> first_done(algorithms.size());
+    bool found = false;
+    route.clear();
+    tasks().parallel_chunks(algorithms.size(), 1, 0, [&](const size_t &i, const size_t &, const size_t &) -> void
+                            {
+                                Workspace workspace(*this);
+                                workspace.cancel_on(&stop);
+                                R own_route;
+                                bool own_found = (this->*algorithms[i])(source->second, target->second, own_route, workspace);
+                                size_t nobody = algorithms.size();
+                                if (!first_done.compare_exchange_strong(nobody, i))
+                                    return;
+                                stop.store(true, std::memory_order_relaxed);
+                                found = own_found;
+                                route += own_route; });
+    winner = search_modes[first_done.load()];
+    return found ? FOUND : UNTRAVERSABLE;
+}
+
+Lattice::SearchMode Lattice::auto_mode(const TripPlan &trip_plan) const
+{
+    auto source = graph.find(trip_plan.source); // check source validity
+    if (source == graph.end())
+        throw InvalidSource(trip_plan.source);
+
+    auto target = graph.find(trip_plan.target); // check target validity
+    if (target == graph.end())
+        throw InvalidTarget(trip_plan.target);
+
+    return choose_mode(source->second, target->second);
+}
+
+// AUTO buckets a query by whether both ends share a component and by how far apart they are
+size_t Lattice::query_class(const Node *source, const Node *target) const noexcept
+{
+    size_t gap = manhattan_distance(source->position, target->position);
+    size_t distance_class = gap < near_distance ? 0 : gap < far_distance ? 1 : 2;
+    bool same_component = !congraph.empty() && source->super == target->super;
+    return (same_component ? 0 : distance_classes) + distance_class;
 }
 
-Lattice::Route Lattice::super_search(const TripPlan &trip_plan,
-                                     const SearchMode &super_search_mode,
-                                     const SearchMode &sub_search_mode) const
+Lattice::SearchMode Lattice::choose_mode(const Node *source, const Node *target) const noexcept
 {
-    if (graph.find(trip_plan.source) == graph.end()) // check source validity
-        throw InvalidSource(trip_plan.source);
-    Node *source = graph.at(trip_plan.source);
+    return auto_modes[query_class(source, target)];
+}
 
-    if (graph.find(trip_plan.target) == graph.end()) // check target validity
-        throw InvalidTarget(trip_plan.target);
-    Node *target = graph.at(trip_plan.target);
+// Cheap features gathered when the world is loaded and again when it is condensed. They seed
+// AUTO with a guess until calibrate_auto_mode() measures the real thing: open worlds with a
+// high branching factor suit A*, while corridors and mazes, where Manhattan distance says little
+// about the real route, suit BFS once the ends are not close.
+void Lattice::profile_world() noexcept
+{
+    profile = WorldProfile();
+    profile.node_count = nodes.size();
+    for (const Node *node : nodes)
+        profile.arc_count += node->outgoings.size();
+    profile.branching_factor = nodes.empty() ? 0 : double(profile.arc_count) / nodes.size();
+    profile.component_count = congraph.size();
+    for (const SuperNode *super_node : congraph)
+        profile.largest_component = std::max(profile.largest_component, super_node->internals.size());
+
+    // condensing pays for a super search only when no one component holds most of the world
+    auto_goes_super = profile.component_count > 1 &&
+                      profile.largest_component < super_largest_share * profile.node_count;
+
+    bool is_open = profile.branching_factor >= open_branching_factor;
+    for (size_t query = 0; query < 2 * distance_classes; ++query)
+        auto_modes[query] = query % distance_classes == 0 || is_open ? A_STAR : BFS;
+}
 
-    SuperAlgorithm super_algorithm = get_super_algorithm(super_search_mode);
-    if (super_algorithm == nullptr)
-        throw InvalidSearchMode(super_search_mode);
+// Times every candidate mode on up to samples reachable pairs from each query class and keeps
+// the fastest one per class. A candidate that misses a route or finds one of another length than
+// bfs on any sample is rejected, so AUTO never trades correctness for speed. Call it after
+// condense(), like condense() before sharing the lattice between threads.
+void Lattice::calibrate_auto_mode(const size_t &samples)
+{
+    static constexpr SearchMode candidates[] = {BFS, DFS, GBFS, A_STAR};
+    if (nodes.size() < 2 || samples == 0)
+        return;
+    std::vector<std::pair<Node *, Node *>> pairs[2 * distance_classes];
+    std::mt19937_64 rng(nodes.size());
+    for (size_t attempt = 0, full = 0; attempt < 64 * samples * 2 * distance_classes && full < 2 * distance_classes; ++attempt)
+    {
+        Node *source = nodes[rng() % nodes.size()], *target = nodes[rng() % nodes.size()];
+        std::vector<std::pair<Node *, Node *>> &bucket = pairs[query_class(source, target)];
+        if (bucket.size() == samples || !reachable(source, target))
+            continue;
+        bucket.emplace_back(source, target);
+        full += bucket.size() == samples;
+    }
 
-    if (source->super != target->super)
+    Workspace workspace(*this);
+    _2Ls::Chronometer X;
+    for (size_t query = 0; query < 2 * distance_classes; ++query)
     {
-        std::cout << "SUPER\n";
-        try
+        if (pairs[query].empty())
+            continue;
+        std::vector<size_t> lengths;
+        for (const auto &[source, target] : pairs[query])
         {
-            return (this->*super_algorithm)(source, target, sub_search_mode);
+            RouteLength length;
+            bfs(source, target, length, workspace);
+            lengths.push_back(length.size());
         }
-        catch (const std::exception &e)
+        double best_time = 0;
+        bool accepted = false;
+        for (const SearchMode &candidate : candidates)
         {
-            throw;
+            AlgorithmOf<RouteLength> algorithm = get_algorithm<RouteLength>(candidate);
+            bool agrees = true;
+            X.set_hi_res_start();
+            for (size_t pair = 0; pair < pairs[query].size(); ++pair)
+            {
+                RouteLength length;
+                agrees &= (this->*algorithm)(pairs[query][pair].first, pairs[query][pair].second, length, workspace) &&
+                          length.size() == lengths[pair];
+            }
+            X.set_hi_res_end();
+            if (agrees && (!accepted || X.get_ns() < best_time))
+                best_time = X.get_ns(), auto_modes[query] = candidate, accepted = true;
         }
     }
+}
 
-    Algorithm algorithm = get_algorithm(sub_search_mode);
-    if (algorithm == nullptr)
-        throw InvalidSearchMode(sub_search_mode);
+void Lattice::set_route_cache_budget(const size_t &bytes)
+{
+    if (routes != nullptr)
+        routes->set_budget(bytes);
+}
 
-    try
-    {
-        return (this->*algorithm)(source, target);
-    }
-    catch (const std::exception &e)
-    {
-        throw;
-    }
+Lattice::RouteCacheStats Lattice::route_cache_stats() const
+{
+    return routes != nullptr ? routes->stats() : RouteCacheStats{0, 0, 0, 0};
+}
+
+// Swaps in a new pool rather than resizing the old one, so copies of the lattice already sharing
+// it keep theirs. Like condense(), call it while no search is running.
+void Lattice::set_thread_count(const size_t &threads, const bool &pin_threads)
+{
+    scheduler = std::make_shared<_2Ls::TaskScheduler>(threads, pin_threads);
+}
+
+size_t Lattice::thread_count() const noexcept
+{
+    return tasks().thread_count();
 }
 
-Lattice::Algorithm Lattice::get_algorithm(const SearchMode &search_mode) const noexcept
+// A default constructed lattice has no pool of its own and runs everything on the caller.
+_2Ls::TaskScheduler &Lattice::tasks() const noexcept
+{
+    static _2Ls::TaskScheduler caller_only(1);
+    return scheduler != nullptr ? *scheduler : caller_only;
+}
+
+template <typename R>
+Lattice::AlgorithmOf<R> Lattice::get_algorithm(const SearchMode &search_mode) const noexcept
 {
     switch (search_mode)
     {
     case DFS:
-        return &Lattice::dfs;
+        return &Lattice::dfs<R>;
     case REVERSE_DFS:
-        return &Lattice::rdfs;
+        return &Lattice::rdfs<R>;
     case BIDIRECTIONAL_DFS:
-        return &Lattice::bddfs;
+        return &Lattice::bddfs<R>;
     case BFS:
-        return &Lattice::bfs;
+        return &Lattice::bfs<R>;
     case REVERSE_BFS:
-        return &Lattice::rbfs;
+        return &Lattice::rbfs<R>;
     case BIDIRECTIONAL_BFS:
-        return &Lattice::bdbfs;
+        return &Lattice::bdbfs<R>;
     case GBFS:
-        return &Lattice::gbfs;
+        return &Lattice::gbfs<R>;
     case REVERSE_GBFS:
-        return &Lattice::rgbfs;
+        return &Lattice::rgbfs<R>;
     case BIDIRECTIONAL_GBFS:
-        return &Lattice::bdgbfs;
+        return &Lattice::bdgbfs<R>;
     case NEGATIVE_GBFS:
-        return &Lattice::ngbfs;
+        return &Lattice::ngbfs<R>;
     case REVERSE_NEGATIVE_GBFS:
-        return &Lattice::rngbfs;
+        return &Lattice::rngbfs<R>;
     case BIDIRECTIONAL_NEGATIVE_GBFS:
-        return &Lattice::bdngbfs;
+        return &Lattice::bdngbfs<R>;
     case A_STAR:
-        return &Lattice::astar;
+        return &Lattice::astar<R>;
     case REVERSE_A_STAR:
-        return &Lattice::rastar;
+        return &Lattice::rastar<R>;
     case BIDIRECTIONAL_A_STAR:
-        return &Lattice::bdastar;
+        return &Lattice::bdastar<R>;
     case NEGATIVE_A_STAR:
-        return &Lattice::nastar;
+        return &Lattice::nastar<R>;
     case REVERSE_NEGATIVE_A_STAR:
-        return &Lattice::rnastar;
+        return &Lattice::rnastar<R>;
     case BIDIRECTIONAL_NEGATIVE_A_STAR:
-        return &Lattice::bdnastar;
+        return &Lattice::bdnastar<R>;
+    case PARALLEL_BIDIRECTIONAL_DFS:
+        return &Lattice::pbddfs<R>;
+    case PARALLEL_BIDIRECTIONAL_BFS:
+        return &Lattice::pbdbfs<R>;
+    case PARALLEL_BIDIRECTIONAL_GBFS:
+        return &Lattice::pbdgbfs<R>;
+    case PARALLEL_BIDIRECTIONAL_NEGATIVE_GBFS:
+        return &Lattice::pbdngbfs<R>;
+    case PARALLEL_BIDIRECTIONAL_A_STAR:
+        return &Lattice::pbdastar<R>;
+    case PARALLEL_BIDIRECTIONAL_NEGATIVE_A_STAR:
+        return &Lattice::pbdnastar<R>;
+    case DIRECTION_OPTIMIZING_BFS:
+        return &Lattice::dobfs<R>;
+    case HASH_DISTRIBUTED_A_STAR:
+        return &Lattice::hdastar<R>;
+    case AUTO: // resolved to a concrete mode per query before any lookup
+        break;
     }
     return nullptr;
 }
 
-Lattice::SuperAlgorithm Lattice::get_super_algorithm(const SearchMode &search_mode) const noexcept
+template <typename R>
+Lattice::SuperAlgorithmOf<R> Lattice::get_super_algorithm(const SearchMode &search_mode) const noexcept
 {
     switch (search_mode)
     {
     case DFS:
-        return &Lattice::super_dfs;
+        return &Lattice::super_dfs<R>;
     case REVERSE_DFS:
-        return &Lattice::super_rdfs;
+        return &Lattice::super_rdfs<R>;
     case BIDIRECTIONAL_DFS:
-        return &Lattice::super_bddfs;
+        return &Lattice::super_bddfs<R>;
     case BFS:
-        return &Lattice::super_bfs;
+        return &Lattice::super_bfs<R>;
     case REVERSE_BFS:
-        return &Lattice::super_rbfs;
+        return &Lattice::super_rbfs<R>;
     case BIDIRECTIONAL_BFS:
-        return &Lattice::super_bdbfs;
+        return &Lattice::super_bdbfs<R>;
     case GBFS:
-        return &Lattice::super_gbfs;
+        return &Lattice::super_gbfs<R>;
     case REVERSE_GBFS:
-        return &Lattice::super_rgbfs;
+        return &Lattice::super_rgbfs<R>;
     case BIDIRECTIONAL_GBFS:
-        return &Lattice::super_bdgbfs;
+        return &Lattice::super_bdgbfs<R>;
     case NEGATIVE_GBFS:
-        return &Lattice::super_ngbfs;
+        return &Lattice::super_ngbfs<R>;
     case REVERSE_NEGATIVE_GBFS:
-        return &Lattice::super_rngbfs;
+        return &Lattice::super_rngbfs<R>;
     case BIDIRECTIONAL_NEGATIVE_GBFS:
-        return &Lattice::super_bdngbfs;
+        return &Lattice::super_bdngbfs<R>;
     case A_STAR:
-        return &Lattice::super_astar;
+        return &Lattice::super_astar<R>;
     case REVERSE_A_STAR:
-        return &Lattice::super_rastar;
+        return &Lattice::super_rastar<R>;
     case BIDIRECTIONAL_A_STAR:
-        return &Lattice::super_bdastar;
+        return &Lattice::super_bdastar<R>;
     case NEGATIVE_A_STAR:
-        return &Lattice::super_nastar;
+        return &Lattice::super_nastar<R>;
     case REVERSE_NEGATIVE_A_STAR:
-        return &Lattice::super_rnastar;
+        return &Lattice::super_rnastar<R>;
     case BIDIRECTIONAL_NEGATIVE_A_STAR:
-        return &Lattice::super_bdnastar;
+        return &Lattice::super_bdnastar<R>;
+    case PARALLEL_BIDIRECTIONAL_DFS: // parallel modes only run inside a single component
+    case PARALLEL_BIDIRECTIONAL_BFS:
+    case PARALLEL_BIDIRECTIONAL_GBFS:
+    case PARALLEL_BIDIRECTIONAL_NEGATIVE_GBFS:
+    case PARALLEL_BIDIRECTIONAL_A_STAR:
+    case PARALLEL_BIDIRECTIONAL_NEGATIVE_A_STAR:
+    case DIRECTION_OPTIMIZING_BFS:
+    case HASH_DISTRIBUTED_A_STAR:
+    case AUTO: // resolved to a concrete mode per query before any lookup
+        break;
     }
     return nullptr;
 }
 
-Lattice::Route Lattice::dfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::dfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::DFS_F);
 
     for (Node *current_f = source;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_f == target)
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::rdfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::rdfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::DFS_B);
 
     for (Node *current_b = target;;)
     {
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_b == source)
         {
-            Route route = meta_data_b.retrace_route(current_b);
-            return route;
+            meta_data_b.retrace_route(current_b, route);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::bddfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::bddfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return "";
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::DFS_F);
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::DFS_B);
 
     for (Node *current_f = source, *current_b = target;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_b.visited(current_f))
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_f);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_f, route);
+            return true;
         }
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_f.visited(current_b))
         {
-            Route route = meta_data_f.retrace_route(current_b);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_b);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_b, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_b, route);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::bfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::bfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::BFS_F);
 
     for (Node *current_f = source;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_f == target)
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::rbfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::rbfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::BFS_B);
 
     for (Node *current_b = target;;)
     {
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_b == source)
         {
-            Route route = meta_data_b.retrace_route(current_b);
-            return route;
+            meta_data_b.retrace_route(current_b, route);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::bdbfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::bdbfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return "";
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::BFS_F);
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::BFS_B);
 
     for (Node *current_f = source, *current_b = target;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_b.visited(current_f))
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_f);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_f, route);
+            return true;
         }
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_f.visited(current_b))
         {
-            Route route = meta_data_f.retrace_route(current_b);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_b);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_b, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_b, route);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::gbfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::gbfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::GBFS_F);
 
     for (Node *current_f = source;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_f == target)
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::rgbfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::rgbfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::GBFS_B);
 
     for (Node *current_b = target;;)
     {
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_b == source)
         {
-            Route route = meta_data_b.retrace_route(current_b);
-            return route;
+            meta_data_b.retrace_route(current_b, route);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::bdgbfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::bdgbfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return "";
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::GBFS_F);
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::GBFS_B);
 
     for (Node *current_f = source, *current_b = target;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_b.visited(current_f))
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_f);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_f, route);
+            return true;
         }
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_f.visited(current_b))
         {
-            Route route = meta_data_f.retrace_route(current_b);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_b);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_b, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_b, route);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::ngbfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::ngbfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::NGBFS_F);
 
     for (Node *current_f = source;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_f == target)
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::rngbfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::rngbfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::NGBFS_B);
 
     for (Node *current_b = target;;)
     {
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_b == source)
         {
-            Route route = meta_data_b.retrace_route(current_b);
-            return route;
+            meta_data_b.retrace_route(current_b, route);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::bdngbfs(Node *source, Node *target) const
+template <typename R>
+bool Lattice::bdngbfs(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return "";
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::NGBFS_F);
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::NGBFS_B);
 
     for (Node *current_f = source, *current_b = target;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_b.visited(current_f))
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_f);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_f, route);
+            return true;
         }
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_f.visited(current_b))
         {
-            Route route = meta_data_f.retrace_route(current_b);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_b);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_b, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_b, route);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::astar(Node *source, Node *target) const
+template <typename R>
+bool Lattice::astar(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::ASTAR_F);
 
     for (Node *current_f = source;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_f == target)
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::rastar(Node *source, Node *target) const
+template <typename R>
+bool Lattice::rastar(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::ASTAR_B);
 
     for (Node *current_b = target;;)
     {
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_b == source)
         {
-            Route route = meta_data_b.retrace_route(current_b);
-            return route;
+            meta_data_b.retrace_route(current_b, route);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::bdastar(Node *source, Node *target) const
+template <typename R>
+bool Lattice::bdastar(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return "";
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::ASTAR_F);
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::ASTAR_B);
 
     for (Node *current_f = source, *current_b = target;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_b.visited(current_f))
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_f);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_f, route);
+            return true;
         }
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_f.visited(current_b))
         {
-            Route route = meta_data_f.retrace_route(current_b);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_b);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_b, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_b, route);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::nastar(Node *source, Node *target) const
+template <typename R>
+bool Lattice::nastar(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::NASTAR_F);
 
     for (Node *current_f = source;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_f == target)
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::rnastar(Node *source, Node *target) const
+template <typename R>
+bool Lattice::rnastar(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return Route();
+        return true;
 
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::NASTAR_B);
 
     for (Node *current_b = target;;)
     {
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (current_b == source)
         {
-            Route route = meta_data_b.retrace_route(current_b);
-            return route;
+            meta_data_b.retrace_route(current_b, route);
+            return true;
         }
     }
 }
 
-Lattice::Route Lattice::bdnastar(Node *source, Node *target) const
+template <typename R>
+bool Lattice::bdnastar(Node *source, Node *target, R &route, Workspace &workspace) const
 {
     if (source == target) // trivial case
-        return "";
+        return true;
 
-    MetaData meta_data_f(graph.size());
+    MetaData &meta_data_f = workspace.meta_data_f;
     meta_data_f.configure(source, target, MetaData::NASTAR_F);
-    MetaData meta_data_b(graph.size());
+    MetaData &meta_data_b = workspace.meta_data_b;
     meta_data_b.configure(target, source, MetaData::NASTAR_B);
 
     for (Node *current_f = source, *current_b = target;;)
     {
         current_f = meta_data_f.extract_next(current_f);
         if (current_f == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_b.visited(current_f))
         {
-            Route route = meta_data_f.retrace_route(current_f);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_f);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_f, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_f, route);
+            return true;
         }
         current_b = meta_data_b.extract_next(current_b);
         if (current_b == nullptr)
-            throw Untraversable(source->position, target->position);
+            return false;
         if (meta_data_f.visited(current_b))
         {
-            Route route = meta_data_f.retrace_route(current_b);
-            std::reverse(route.begin(), route.end());
-            route += meta_data_b.retrace_route(current_b);
-            return route;
+            size_t first = route.size();
+            meta_data_f.retrace_route(current_b, route);
+            reverse_route(route, first);
+            meta_data_b.retrace_route(current_b, route);
+            return true;
+        }
+    }
+}
+
+template <typename R>
+bool Lattice::pbddfs(Node *source, Node *target, R &route, Workspace &workspace) const
+{
+    return parallel_bidirectional(source, target, DFS, route, workspace);
+}
+
+template <typename R>
+bool Lattice::pbdbfs(Node *source, Node *target, R &route, Workspace &workspace) const
+{
+    return parallel_bidirectional(source, target, BFS, route, workspace);
+}
+
+template <typename R>
+bool Lattice::pbdgbfs(Node *source, Node *target, R &route, Workspace &workspace) const
+{
+    return parallel_bidirectional(source, target, GBFS, route, workspace);
+}
+
+template <typename R>
+bool Lattice::pbdngbfs(Node *source, Node *target, R &route, Workspace &workspace) const
+{
+    return parallel_bidirectional(source, target, NEGATIVE_GBFS, route, workspace);
+}
+
+template <typename R>
+bool Lattice::pbdastar(Node *source, Node *target, R &route, Workspace &workspace) const
+{
+    return parallel_bidirectional(source, target, A_STAR, route, workspace);
+}
+
+template <typename R>
+bool Lattice::pbdnastar(Node *source, Node *target, R &route, Workspace &workspace) const
+{
+    return parallel_bidirectional(source, target, NEGATIVE_A_STAR, route, workspace);
+}
+
+// level by level over every hardware thread, see expand_levels
+template <typename R>
+bool Lattice::dobfs(Node *source, Node *target, R &route, Workspace &workspace) const
+{
+    if (source == target) // trivial case
+        return true;
+
+    Levels &levels = workspace.levels;
+    levels.reset(nodes.size(), true);
+    expand_levels(source, target, unreachable, 0, levels, workspace.cancellation());
+    if (!levels.is_reached(target->id))
+        return false;
+    size_t first = route.size();
+    for (Node *n = target; n != source; n = levels.last[n->id])
+        route.push_back(levels.move[n->id]);
+    reverse_route(route, first);
+    return true;
+}
+
+// Hash-distributed A* (HDA*). Every node belongs to the partition its id hashes to, one per
+// scheduler thread, and only the task draining a partition touches its g costs and parents, so
+// node state needs no locks. Each partition keeps its own open list, and successors generated for
+// other partitions go out in batches through their mailboxes. Posting a batch schedules a drain
+// of the receiving partition unless one is already running, and a drain ends once its open list
+// and mailbox are both empty, so the search is over when the task group is: no drain left and no
+// batch that hasn't been handed to one. The best route to the target found so far prunes every
+// open list.
+//
+// Routes are stable in length only. h leaves out height, since one move can fall any number of
+// floors, so it never overestimates and every run ends on a shortest route, as long as bfs's.
+// Open lists break ties on node id and a node keeps the lowest-id parent among equally short ones
+// it hears of, but which of those it hears of before the search ends depends on how the
+// partitions interleave, so two runs may return different shortest routes.
+template <typename R>
+bool Lattice::hdastar(Node *source, Node *target, R &route, Workspace &workspace) const
+{
+    if (source == target) // trivial case
+        return true;
+
+    struct Message
+    {
+        uint32_t id, g, parent;
+        Move move;
+    };
+    struct Entry
+    {
+        uint32_t f, g, id;
+    };
+    struct EntryId
+    {
+        size_t operator()(const Entry &entry) const noexcept { return entry.id; }
+    };
+    struct Before // lowest f first, deepest first among ties, then lowest id
+    {
+        bool operator()(const Entry &a, const Entry &b) const noexcept
+        {
+            return a.f < b.f || (a.f == b.f && (a.g > b.g || (a.g == b.g && a.id < b.id)));
+        }
+    };
+    using OpenList = _2Ls::BoxIndexedBinaryHeap<Entry, EntryId, Before, false>;
+    using Mailbox = MpscMailbox<Message>;
+    using Batch = typename Mailbox::Batch;
+    struct Partition
+    {
+        OpenList open;
+        Mailbox mailbox;
+        std::atomic<bool> draining{false};
+    };
+    static constexpr uint32_t none = UINT32_MAX;
+    static constexpr size_t expansions_per_round = 64;
+
+    _2Ls::TaskScheduler &scheduler = tasks();
+    size_t partitions = std::min<size_t>(scheduler.thread_count(), 64);
+    uint32_t *g = new uint32_t[nodes.size()];
+    std::fill(g, g + nodes.size(), none);
+    Node **last = new Node *[nodes.size()];
+    Move *move = new Move[nodes.size()];
+    Partition *partition = new Partition[partitions];
+    for (size_t p = 0; p < partitions; ++p)
+        partition[p].open = OpenList(nodes.size(), nodes.size());
+    std::atomic<uint32_t> incumbent(none);
+    auto owner = [partitions](const uint32_t &id) -> size_t
+    { return (uint64_t(id) * 0x9e3779b97f4a7c15ULL >> 32) % partitions; };
+    auto h = [target](const Node *n) -> uint32_t // every move is one step across, whatever it climbs or falls
+    { return std::abs(n->position.x - target->position.x) + std::abs(n->position.y - target->position.y); };
+    auto relax = [&](OpenList &open, const Message &message) -> void
+    {
+        if (message.g > g[message.id])
+            return;
+        if (message.g == g[message.id]) // as short, so only a lower-id parent is taken
+        {
+            if (message.parent != none && message.parent < last[message.id]->id)
+                last[message.id] = nodes[message.parent], move[message.id] = message.move;
+            return;
+        }
+        g[message.id] = message.g;
+        last[message.id] = message.parent == none ? nullptr : nodes[message.parent];
+        move[message.id] = message.move;
+        Entry entry = {message.g + h(nodes[message.id]), message.g, message.id};
+        if (open.contains(message.id))
+            open.decrease_key(entry);
+        else
+            open.push(entry);
+    };
+
+    _2Ls::TaskScheduler::TaskGroup group(scheduler);
+    std::function<void(const size_t &)> drain;
+    auto wake = [&](const size_t &to) -> void
+    {
+        if (!partition[to].draining.exchange(true))
+            group.run([&drain, to]() -> void
+                      { drain(to); });
+    };
+    drain = [&](const size_t &self) -> void
+    {
+        OpenList &open = partition[self].open;
+        std::vector<std::vector<Message>> outbox(partitions);
+        while (!workspace.cancelled())
+        {
+            for (Batch *batch = partition[self].mailbox.take_all(), *next; batch != nullptr; batch = next)
+            {
+                for (const Message &message : batch->items)
+                    relax(open, message);
+                next = batch->next, delete batch;
+            }
+            for (size_t expansions = 0; !open.empty() && expansions < expansions_per_round;)
+            {
+                Entry current = open.extract();
+                if (current.f >= incumbent.load(std::memory_order_relaxed)) // nothing left here can win
+                {
+                    open.clear();
+                    break;
+                }
+                if (current.id == target->id)
+                {
+                    for (uint32_t best = incumbent.load(); current.g < best && !incumbent.compare_exchange_weak(best, current.g);)
+                        ;
+                    continue;
+                }
+                ++expansions;
+                for (Arc *arc : nodes[current.id]->outgoings)
+                {
+                    Message message = {uint32_t(arc->next->id), current.g + 1, current.id, arc->move};
+                    if (message.g + h(arc->next) >= incumbent.load(std::memory_order_relaxed))
+                        continue;
+                    size_t to = owner(message.id);
+                    if (to == self)
+                        relax(open, message);
+                    else
+                        outbox[to].push_back(message);
+                }
+            }
+            for (size_t to = 0; to < partitions; ++to)
+                if (!outbox[to].empty())
+                {
+                    partition[to].mailbox.push(new Batch{nullptr, std::move(outbox[to])});
+                    outbox[to].clear();
+                    wake(to);
+                }
+            if (open.empty() && partition[self].mailbox.empty())
+            {
+                partition[self].draining.store(false); // a batch posted before this is seen below
+                if (partition[self].mailbox.empty() || partition[self].draining.exchange(true))
+                    return;
+            }
+        }
+    };
+    relax(partition[owner(source->id)].open, {uint32_t(source->id), 0, none, 'n'});
+    partition[owner(source->id)].draining = true;
+    group.run([&drain, &owner, source]() -> void
+              { drain(owner(source->id)); });
+    group.wait();
+
+    bool found = incumbent.load() != none && !workspace.cancelled();
+    if (found)
+    {
+        size_t first = route.size();
+        for (Node *n = target; n != source; n = last[n->id])
+            route.push_back(move[n->id]);
+        reverse_route(route, first);
+    }
+    delete[] g;
+    delete[] last;
+    delete[] move;
+    delete[] partition;
+    return found;
+}
+
+// The forward side expands on the calling thread and the backward side as a task another thread
+// of the scheduler picks up. Each side stamps the nodes it extracts in the workspace's meeting
+// marks, and the first to extract a node the other already has claims it as the meeting point and
+// tells both sides to stop. Either side running dry before that means there is no route. With no
+// thread free the backward task runs after the forward side, which then ends on the target.
+template <typename R>
+bool Lattice::parallel_bidirectional(Node *source, Node *target, const SearchMode &one_way, R &route,
+                                     Workspace &workspace) const
+{
+    if (source == target) // trivial case
+        return true;
+
+    MetaData::Mode forward, backward;
+    switch (one_way)
+    {
+    case DFS:
+        forward = MetaData::DFS_F, backward = MetaData::DFS_B;
+        break;
+    case BFS:
+        forward = MetaData::BFS_F, backward = MetaData::BFS_B;
+        break;
+    case GBFS:
+        forward = MetaData::GBFS_F, backward = MetaData::GBFS_B;
+        break;
+    case NEGATIVE_GBFS:
+        forward = MetaData::NGBFS_F, backward = MetaData::NGBFS_B;
+        break;
+    case A_STAR:
+        forward = MetaData::ASTAR_F, backward = MetaData::ASTAR_B;
+        break;
+    default:
+        forward = MetaData::NASTAR_F, backward = MetaData::NASTAR_B;
+        break;
+    }
+    MetaData &meta_data_f = workspace.meta_data_f;
+    meta_data_f.configure(source, target, forward);
+    MetaData &meta_data_b = workspace.meta_data_b;
+    meta_data_b.configure(target, source, backward);
+    workspace.begin_meeting();
+    workspace.meet(source, 1);
+    workspace.meet(target, 2);
+
+    std::atomic<bool> stop(false);
+    std::atomic<Node *> meeting(nullptr);
+    auto expand = [&](MetaData &meta_data, Node *current, const uint32_t &side) -> void
+    {
+        while (!stop.load(std::memory_order_relaxed))
+        {
+            current = meta_data.extract_next(current);
+            if (current == nullptr || workspace.meet(current, side) != 0)
+            {
+                Node *none = nullptr;
+                if (current != nullptr)
+                    meeting.compare_exchange_strong(none, current);
+                stop.store(true, std::memory_order_relaxed);
+                return;
+            }
+        }
+    };
+    _2Ls::TaskScheduler::TaskGroup group(tasks());
+    group.run([&]() -> void
+              {
+                  try
+                  {
+                      expand(meta_data_b, target, 2);
+                  }
+                  catch (...)
+                  {
+                      stop = true;
+                      throw;
+                  } });
+    try
+    {
+        expand(meta_data_f, source, 1);
+    }
+    catch (...)
+    {
+        stop = true;
+        throw; // the group waits for the backward side on the way out
+    }
+    group.wait();
+
+    Node *middle = meeting.load();
+    if (middle == nullptr)
+        return false;
+    size_t first = route.size();
+    meta_data_f.retrace_route(middle, route);
+    reverse_route(route, first);
+    meta_data_b.retrace_route(middle, route);
+    return true;
+}
+
+// The super searches only ever look at the first portal between two components. Once the chain
+// is known, each crossing, walking it forwards, moves to the portal nearest to where its component
+// was entered, which keeps legs short when neighbours share a long border.
+//
+// Then legs already in their component's portal memo are copied from it. The rest don't depend on
+// each other, so each resolves into its own slot on whichever thread of the scheduler takes it
+// and is memoized on the way out only if it was found. The slots are then joined in order with
+// the crossings between them, unless a leg failed, in which case the route is left alone and the
+// super search reports no route. The classic modes run on the component's locals with a
+// workspace sized to it, so a leg never leaves its component nor pays for arrays the size of the
+// world. The parallel modes search the whole lattice, the caller's workspace serving slot 0.
+template <typename R>
+bool Lattice::resolve_legs(std::vector<Leg> &legs, const SearchMode &sub_search_mode, R &route,
+                           Workspace &workspace) const
+{
+    for (size_t i = 0; i + 1 < legs.size(); ++i)
+        for (SuperArc *super_arc : legs[i].entry->super->outgoings)
+            if (super_arc->next == legs[i + 1].entry->super)
+            {
+                const SuperArc::Portal *nearest = &super_arc->portals.front();
+                for (const SuperArc::Portal &portal : super_arc->portals)
+                    if (manhattan_distance(legs[i].entry->position, portal.exit->position) <
+                        manhattan_distance(legs[i].entry->position, nearest->exit->position))
+                        nearest = &portal;
+                legs[i].exit = nearest->exit, legs[i].move = nearest->link->move;
+                legs[i + 1].entry = nearest->link->next;
+                break;
+            }
+
+    AlgorithmOf<R> algorithm = get_algorithm<R>(sub_search_mode); // checked by the caller
+    std::vector<R> slots(legs.size());
+    std::vector<size_t> misses;
+    for (size_t i = 0; i < legs.size(); ++i)
+        if (legs[i].entry != legs[i].exit &&
+            !legs[i].entry->super->portal_routes->find(legs[i].entry, legs[i].exit, sub_search_mode, slots[i]))
+            misses.push_back(i);
+    bool local = sub_search_mode < PARALLEL_BIDIRECTIONAL_DFS; // modes that only touch their workspace
+    std::atomic<bool> failed(false);
+    auto resolve = [&](const size_t &i, Workspace &own) -> void
+    {
+        SuperNode *component = legs[i].entry->super;
+        bool found;
+        if (local)
+        {
+            Workspace component_workspace(*this, component);
+            component_workspace.cancel_on(own.cancellation());
+            found = (this->*algorithm)(component->locals[legs[i].entry->local],
+                                       component->locals[legs[i].exit->local], slots[i], component_workspace);
         }
+        else
+            found = (this->*algorithm)(legs[i].entry, legs[i].exit, slots[i], own);
+        if (found)
+            component->portal_routes->insert(legs[i].entry, legs[i].exit, sub_search_mode, slots[i]);
+        else
+            failed = true;
+    };
+
+    _2Ls::TaskScheduler &scheduler = tasks();
+    if (misses.size() == 1 || scheduler.thread_count() == 1)
+        for (const size_t &i : misses)
+            resolve(i, workspace);
+    else if (!misses.empty())
+    {
+        std::vector<std::unique_ptr<Workspace>> workspaces(scheduler.thread_count());
+        scheduler.parallel_chunks(misses.size(), 1, 0, [&](const size_t &m, const size_t &, const size_t &slot) -> void
+                                  {
+                                      if (slot != 0 && !local && workspaces[slot] == nullptr)
+                                          workspaces[slot].reset(new Workspace(*this));
+                                      resolve(misses[m], slot == 0 || local ? workspace : *workspaces[slot]); });
+    }
+    if (failed) // cancelled, or a mode that misses routes; nothing partial reaches the route
+        return false;
+    for (size_t i = 0; i < legs.size(); ++i)
+    {
+        route += slots[i];
+        if (legs[i].move != 0)
+            route.push_back(legs[i].move);
     }
+    return true;
 }
 
-Lattice::Route Lattice::super_dfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_dfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -1188,11 +3527,13 @@ Lattice::Route Lattice::super_dfs(Node *source, Node *target, const SearchMode &
     Node **exit = new Node *[congraph.size()](),
          **entry = new Node *[congraph.size()]();
     Move *move = new Move[congraph.size()]();
-    std::stack<SuperNode *> open_set;
+    _2Ls::BoxStack<SuperNode *, false> open_set(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_source;
         exit[super_arc->next->id] = super_arc->exit;
         entry[super_arc->next->id] = super_arc->link->next;
@@ -1203,25 +3544,23 @@ Lattice::Route Lattice::super_dfs(Node *source, Node *target, const SearchMode &
     // search
     while (!open_set.empty())
     {
-        SuperNode *super_current = open_set.top(); // get next node
-        open_set.pop();
+        SuperNode *super_current = open_set.extract(); // get next node
 
         if (super_current == super_target) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             entry[super_source->id] = source;
-            Route route = (this->*algorithm)(entry[super_current->id], target);
-            do
+            reverse_chain(last, super_source, super_current);
+            for (SuperNode *super_hop = super_source; super_hop != super_current;)
             {
-                route.insert(0, 1, move[super_current->id]);
-                Node *temp_exit = exit[super_current->id];
-                super_current = last[super_current->id];
-                route.insert(0, (this->*algorithm)(entry[super_current->id], temp_exit));
-            } while (super_current != super_source);
+                SuperNode *super_next = last[super_hop->id];
+                legs.push_back({entry[super_hop->id], exit[super_next->id], move[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry[super_current->id], target, 0});
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -1239,10 +3578,11 @@ Lattice::Route Lattice::super_dfs(Node *source, Node *target, const SearchMode &
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_rdfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_rdfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -1250,11 +3590,13 @@ Lattice::Route Lattice::super_rdfs(Node *source, Node *target, const SearchMode
     Node **exit = new Node *[congraph.size()](),
          **entry = new Node *[congraph.size()]();
     Move *move = new Move[congraph.size()]();
-    std::stack<SuperNode *> open_set;
+    _2Ls::BoxStack<SuperNode *, false> open_set(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_target->incomings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_target;
         entry[super_arc->next->id] = super_arc->exit;
         exit[super_arc->next->id] = super_arc->link->next;
@@ -1265,25 +3607,23 @@ Lattice::Route Lattice::super_rdfs(Node *source, Node *target, const SearchMode
     // search
     while (!open_set.empty())
     {
-        SuperNode *super_current = open_set.top(); // get next node
-        open_set.pop();
+        SuperNode *super_current = open_set.extract(); // get next node
 
         if (super_current == super_source) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             exit[super_target->id] = target;
-            Route route = (this->*algorithm)(source, exit[super_current->id]);
+            legs.push_back({source, exit[super_current->id], 0});
             do
             {
-                route += move[super_current->id];
+                legs.back().move = move[super_current->id];
                 Node *temp_entry = entry[super_current->id];
                 super_current = last[super_current->id];
-                route += (this->*algorithm)(temp_entry, exit[super_current->id]);
+                legs.push_back({temp_entry, exit[super_current->id], 0});
             } while (super_current != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -1301,10 +3641,11 @@ Lattice::Route Lattice::super_rdfs(Node *source, Node *target, const SearchMode
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_bddfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_bddfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_current_f = super_source,
@@ -1315,11 +3656,13 @@ Lattice::Route Lattice::super_bddfs(Node *source, Node *target, const SearchMode
          **entry_f = new Node *[congraph.size()](), **entry_b = new Node *[congraph.size()]();
     entry_f[super_source->id] = source, exit_b[super_target->id] = target;
     Move *move_f = new Move[congraph.size()](), *move_b = new Move[congraph.size()]();
-    std::stack<SuperNode *> open_set_f, open_set_b;
+    _2Ls::BoxStack<SuperNode *, false> open_set_f(congraph.size()), open_set_b(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings) // (forwards)
     {
+        if (move_f[super_arc->next->id] != 0)
+            continue;
         last_f[super_arc->next->id] = super_source;
         exit_f[super_arc->next->id] = super_arc->exit;
         entry_f[super_arc->next->id] = super_arc->link->next;
@@ -1328,6 +3671,8 @@ Lattice::Route Lattice::super_bddfs(Node *source, Node *target, const SearchMode
     }
     for (SuperArc *super_arc : super_target->incomings) // (backwards)
     {
+        if (move_b[super_arc->next->id] != 0)
+            continue;
         last_b[super_arc->next->id] = super_target;
         entry_b[super_arc->next->id] = super_arc->exit;
         exit_b[super_arc->next->id] = super_arc->link->next;
@@ -1341,68 +3686,63 @@ Lattice::Route Lattice::super_bddfs(Node *source, Node *target, const SearchMode
         if (open_set_f.empty())
             break;
 
-        super_current_f = open_set_f.top(); // get next super node (forwards)
-        open_set_f.pop();
+        super_current_f = open_set_f.extract(); // get next super node (forwards)
 
         if (entry_b[super_current_f->id] != nullptr) // goal check (forwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
 
             super_current_b = super_current_f;
-            Route route = (this->*algorithm)(entry_f[super_current_f->id], exit_b[super_current_f->id]);
-            do
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
             {
-                route.insert(0, 1, move_f[super_current_f->id]);
-                Node *temp_exit = exit_f[super_current_f->id];
-                super_current_f = last_f[super_current_f->id];
-                route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-            } while (super_current_f != super_source);
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_f->id], exit_b[super_current_f->id], 0});
             if (super_current_b != super_target)
                 do
                 {
-                    route += move_b[super_current_b->id];
+                    legs.back().move = move_b[super_current_b->id];
                     Node *temp_entry = entry_b[super_current_b->id];
                     super_current_b = last_b[super_current_b->id];
-                    route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                    legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
                 } while (super_current_b != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         if (open_set_b.empty())
             break;
-        super_current_b = open_set_b.top(); // get next super node (backwards)
-        open_set_b.pop();
+        super_current_b = open_set_b.extract(); // get next super node (backwards)
 
         if (exit_f[super_current_b->id] != nullptr) // goal check (backwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
 
             super_current_f = super_current_b;
-            Route route = (this->*algorithm)(entry_f[super_current_b->id], exit_b[super_current_b->id]);
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
+            {
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_b->id], exit_b[super_current_b->id], 0});
             do
             {
-                route += move_b[super_current_b->id];
+                legs.back().move = move_b[super_current_b->id];
                 Node *temp_entry = entry_b[super_current_b->id];
                 super_current_b = last_b[super_current_b->id];
-                route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
             } while (super_current_b != super_target);
-            if (super_current_b != super_source)
-                do
-                {
-                    route.insert(0, 1, move_f[super_current_f->id]);
-                    Node *temp_exit = exit_f[super_current_f->id];
-                    super_current_f = last_f[super_current_f->id];
-                    route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-                } while (super_current_f != super_source);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -1431,10 +3771,11 @@ Lattice::Route Lattice::super_bddfs(Node *source, Node *target, const SearchMode
     // when no path is found
     delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
         delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_bfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_bfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -1442,11 +3783,13 @@ Lattice::Route Lattice::super_bfs(Node *source, Node *target, const SearchMode &
     Node **exit = new Node *[congraph.size()](),
          **entry = new Node *[congraph.size()]();
     Move *move = new Move[congraph.size()]();
-    std::queue<SuperNode *> open_set;
+    _2Ls::BoxQueue<SuperNode *, false> open_set;
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_source;
         exit[super_arc->next->id] = super_arc->exit;
         entry[super_arc->next->id] = super_arc->link->next;
@@ -1457,25 +3800,23 @@ Lattice::Route Lattice::super_bfs(Node *source, Node *target, const SearchMode &
     // search
     while (!open_set.empty())
     {
-        SuperNode *super_current = open_set.front(); // get next node
-        open_set.pop();
+        SuperNode *super_current = open_set.extract(); // get next node
 
         if (super_current == super_target) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             entry[super_source->id] = source;
-            Route route = (this->*algorithm)(entry[super_current->id], target);
-            do
+            reverse_chain(last, super_source, super_current);
+            for (SuperNode *super_hop = super_source; super_hop != super_current;)
             {
-                route.insert(0, 1, move[super_current->id]);
-                Node *temp_exit = exit[super_current->id];
-                super_current = last[super_current->id];
-                route.insert(0, (this->*algorithm)(entry[super_current->id], temp_exit));
-            } while (super_current != super_source);
+                SuperNode *super_next = last[super_hop->id];
+                legs.push_back({entry[super_hop->id], exit[super_next->id], move[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry[super_current->id], target, 0});
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -1493,10 +3834,11 @@ Lattice::Route Lattice::super_bfs(Node *source, Node *target, const SearchMode &
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_rbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_rbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -1504,11 +3846,13 @@ Lattice::Route Lattice::super_rbfs(Node *source, Node *target, const SearchMode
     Node **exit = new Node *[congraph.size()](),
          **entry = new Node *[congraph.size()]();
     Move *move = new Move[congraph.size()]();
-    std::queue<SuperNode *> open_set;
+    _2Ls::BoxQueue<SuperNode *, false> open_set;
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_target->incomings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_target;
         entry[super_arc->next->id] = super_arc->exit;
         exit[super_arc->next->id] = super_arc->link->next;
@@ -1519,25 +3863,23 @@ Lattice::Route Lattice::super_rbfs(Node *source, Node *target, const SearchMode
     // search
     while (!open_set.empty())
     {
-        SuperNode *super_current = open_set.front(); // get next node
-        open_set.pop();
+        SuperNode *super_current = open_set.extract(); // get next node
 
         if (super_current == super_source) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             exit[super_target->id] = target;
-            Route route = (this->*algorithm)(source, exit[super_current->id]);
+            legs.push_back({source, exit[super_current->id], 0});
             do
             {
-                route += move[super_current->id];
+                legs.back().move = move[super_current->id];
                 Node *temp_entry = entry[super_current->id];
                 super_current = last[super_current->id];
-                route += (this->*algorithm)(temp_entry, exit[super_current->id]);
+                legs.push_back({temp_entry, exit[super_current->id], 0});
             } while (super_current != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -1555,10 +3897,11 @@ Lattice::Route Lattice::super_rbfs(Node *source, Node *target, const SearchMode
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_bdbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_bdbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_current_f = super_source,
@@ -1569,11 +3912,13 @@ Lattice::Route Lattice::super_bdbfs(Node *source, Node *target, const SearchMode
          **entry_f = new Node *[congraph.size()](), **entry_b = new Node *[congraph.size()]();
     entry_f[super_source->id] = source, exit_b[super_target->id] = target;
     Move *move_f = new Move[congraph.size()](), *move_b = new Move[congraph.size()]();
-    std::queue<SuperNode *> open_set_f, open_set_b;
+    _2Ls::BoxQueue<SuperNode *, false> open_set_f, open_set_b;
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings) // (forwards)
     {
+        if (move_f[super_arc->next->id] != 0)
+            continue;
         last_f[super_arc->next->id] = super_source;
         exit_f[super_arc->next->id] = super_arc->exit;
         entry_f[super_arc->next->id] = super_arc->link->next;
@@ -1582,6 +3927,8 @@ Lattice::Route Lattice::super_bdbfs(Node *source, Node *target, const SearchMode
     }
     for (SuperArc *super_arc : super_target->incomings) // (backwards)
     {
+        if (move_b[super_arc->next->id] != 0)
+            continue;
         last_b[super_arc->next->id] = super_target;
         entry_b[super_arc->next->id] = super_arc->exit;
         exit_b[super_arc->next->id] = super_arc->link->next;
@@ -1595,68 +3942,63 @@ Lattice::Route Lattice::super_bdbfs(Node *source, Node *target, const SearchMode
         if (open_set_f.empty())
             break;
 
-        super_current_f = open_set_f.front(); // get next super node (forwards)
-        open_set_f.pop();
+        super_current_f = open_set_f.extract(); // get next super node (forwards)
 
         if (entry_b[super_current_f->id] != nullptr) // goal check (forwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
 
             super_current_b = super_current_f;
-            Route route = (this->*algorithm)(entry_f[super_current_f->id], exit_b[super_current_f->id]);
-            do
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
             {
-                route.insert(0, 1, move_f[super_current_f->id]);
-                Node *temp_exit = exit_f[super_current_f->id];
-                super_current_f = last_f[super_current_f->id];
-                route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-            } while (super_current_f != super_source);
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_f->id], exit_b[super_current_f->id], 0});
             if (super_current_b != super_target)
                 do
                 {
-                    route += move_b[super_current_b->id];
+                    legs.back().move = move_b[super_current_b->id];
                     Node *temp_entry = entry_b[super_current_b->id];
                     super_current_b = last_b[super_current_b->id];
-                    route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                    legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
                 } while (super_current_b != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         if (open_set_b.empty())
             break;
-        super_current_b = open_set_b.front(); // get next super node (backwards)
-        open_set_b.pop();
+        super_current_b = open_set_b.extract(); // get next super node (backwards)
 
         if (exit_f[super_current_b->id] != nullptr) // goal check (backwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
 
             super_current_f = super_current_b;
-            Route route = (this->*algorithm)(entry_f[super_current_b->id], exit_b[super_current_b->id]);
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
+            {
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_b->id], exit_b[super_current_b->id], 0});
             do
             {
-                route += move_b[super_current_b->id];
+                legs.back().move = move_b[super_current_b->id];
                 Node *temp_entry = entry_b[super_current_b->id];
                 super_current_b = last_b[super_current_b->id];
-                route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
             } while (super_current_b != super_target);
-            if (super_current_b != super_source)
-                do
-                {
-                    route.insert(0, 1, move_f[super_current_f->id]);
-                    Node *temp_exit = exit_f[super_current_f->id];
-                    super_current_f = last_f[super_current_f->id];
-                    route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-                } while (super_current_f != super_source);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -1685,10 +4027,11 @@ Lattice::Route Lattice::super_bdbfs(Node *source, Node *target, const SearchMode
     // when no path is found
     delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
         delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_gbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_gbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -1701,42 +4044,42 @@ Lattice::Route Lattice::super_gbfs(Node *source, Node *target, const SearchMode
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMinCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second > b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second < b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMinCmp> open_set;
+    _2Ls::BoxBinaryHeap<Pair, PairMinCmp, false> open_set(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_source;
         exit[super_arc->next->id] = super_arc->exit;
         entry[super_arc->next->id] = super_arc->link->next;
         move[super_arc->next->id] = super_arc->link->move;
-        open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+        open_set.push({super_arc->next, heuristic(super_arc->link->next)});
     }
 
     // search
     while (!open_set.empty())
     {
-        auto [super_current, key] = open_set.top(); // get next node
-        open_set.pop();
+        auto [super_current, key] = open_set.extract(); // get next node
 
         if (super_current == super_target) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             entry[super_source->id] = source;
-            Route route = (this->*algorithm)(entry[super_current->id], target);
-            do
+            reverse_chain(last, super_source, super_current);
+            for (SuperNode *super_hop = super_source; super_hop != super_current;)
             {
-                route.insert(0, 1, move[super_current->id]);
-                Node *temp_exit = exit[super_current->id];
-                super_current = last[super_current->id];
-                route.insert(0, (this->*algorithm)(entry[super_current->id], temp_exit));
-            } while (super_current != super_source);
+                SuperNode *super_next = last[super_hop->id];
+                legs.push_back({entry[super_hop->id], exit[super_next->id], move[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry[super_current->id], target, 0});
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -1748,16 +4091,17 @@ Lattice::Route Lattice::super_gbfs(Node *source, Node *target, const SearchMode
             exit[super_arc->next->id] = super_arc->exit;
             entry[super_arc->next->id] = super_arc->link->next;
             move[super_arc->next->id] = super_arc->link->move;
-            open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+            open_set.push({super_arc->next, heuristic(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_rgbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_rgbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -1770,42 +4114,42 @@ Lattice::Route Lattice::super_rgbfs(Node *source, Node *target, const SearchMode
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMinCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second > b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second < b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMinCmp> open_set;
+    _2Ls::BoxBinaryHeap<Pair, PairMinCmp, false> open_set(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_target->incomings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_target;
         entry[super_arc->next->id] = super_arc->exit;
         exit[super_arc->next->id] = super_arc->link->next;
         move[super_arc->next->id] = super_arc->link->move;
-        open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+        open_set.push({super_arc->next, heuristic(super_arc->link->next)});
     }
 
     // search
     while (!open_set.empty())
     {
-        auto [super_current, key] = open_set.top(); // get next node
-        open_set.pop();
+        auto [super_current, key] = open_set.extract(); // get next node
 
         if (super_current == super_source) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             exit[super_target->id] = target;
-            Route route = (this->*algorithm)(source, exit[super_current->id]);
+            legs.push_back({source, exit[super_current->id], 0});
             do
             {
-                route += move[super_current->id];
+                legs.back().move = move[super_current->id];
                 Node *temp_entry = entry[super_current->id];
                 super_current = last[super_current->id];
-                route += (this->*algorithm)(temp_entry, exit[super_current->id]);
+                legs.push_back({temp_entry, exit[super_current->id], 0});
             } while (super_current != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -1817,16 +4161,17 @@ Lattice::Route Lattice::super_rgbfs(Node *source, Node *target, const SearchMode
             entry[super_arc->next->id] = super_arc->exit;
             exit[super_arc->next->id] = super_arc->link->next;
             move[super_arc->next->id] = super_arc->link->move;
-            open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+            open_set.push({super_arc->next, heuristic(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_bdgbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_bdgbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -1846,26 +4191,30 @@ Lattice::Route Lattice::super_bdgbfs(Node *source, Node *target, const SearchMod
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMinCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second > b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second < b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMinCmp> open_set_f, open_set_b;
+    _2Ls::BoxBinaryHeap<Pair, PairMinCmp, false> open_set_f(congraph.size()), open_set_b(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings) // (forwards)
     {
+        if (move_f[super_arc->next->id] != 0)
+            continue;
         last_f[super_arc->next->id] = super_source;
         exit_f[super_arc->next->id] = super_arc->exit;
         entry_f[super_arc->next->id] = super_arc->link->next;
         move_f[super_arc->next->id] = super_arc->link->move;
-        open_set_f.emplace(super_arc->next, heuristic_f(super_arc->link->next));
+        open_set_f.push({super_arc->next, heuristic_f(super_arc->link->next)});
     }
     for (SuperArc *super_arc : super_target->incomings) // (backwards)
     {
+        if (move_b[super_arc->next->id] != 0)
+            continue;
         last_b[super_arc->next->id] = super_target;
         entry_b[super_arc->next->id] = super_arc->exit;
         exit_b[super_arc->next->id] = super_arc->link->next;
         move_b[super_arc->next->id] = super_arc->link->move;
-        open_set_b.emplace(super_arc->next, heuristic_b(super_arc->link->next));
+        open_set_b.push({super_arc->next, heuristic_b(super_arc->link->next)});
     }
 
     // search
@@ -1874,66 +4223,61 @@ Lattice::Route Lattice::super_bdgbfs(Node *source, Node *target, const SearchMod
         if (open_set_f.empty())
             break;
 
-        std::tie(super_current_f, key_f) = open_set_f.top(); // get next super node (forwards)
-        open_set_f.pop();
+        std::tie(super_current_f, key_f) = open_set_f.extract(); // get next super node (forwards)
 
         if (entry_b[super_current_f->id] != nullptr) // goal check (forwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             super_current_b = super_current_f;
-            Route route = (this->*algorithm)(entry_f[super_current_f->id], exit_b[super_current_f->id]);
-            do
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
             {
-                route.insert(0, 1, move_f[super_current_f->id]);
-                Node *temp_exit = exit_f[super_current_f->id];
-                super_current_f = last_f[super_current_f->id];
-                route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-            } while (super_current_f != super_source);
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_f->id], exit_b[super_current_f->id], 0});
             if (super_current_b != super_target)
                 do
                 {
-                    route += move_b[super_current_b->id];
+                    legs.back().move = move_b[super_current_b->id];
                     Node *temp_entry = entry_b[super_current_b->id];
                     super_current_b = last_b[super_current_b->id];
-                    route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                    legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
                 } while (super_current_b != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         if (open_set_b.empty())
             break;
-        std::tie(super_current_b, key_b) = open_set_b.top(); // get next super node (backwards)
-        open_set_b.pop();
+        std::tie(super_current_b, key_b) = open_set_b.extract(); // get next super node (backwards)
 
         if (exit_f[super_current_b->id] != nullptr) // goal check (backwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             super_current_f = super_current_b;
-            Route route = (this->*algorithm)(entry_f[super_current_b->id], exit_b[super_current_b->id]);
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
+            {
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_b->id], exit_b[super_current_b->id], 0});
             do
             {
-                route += move_b[super_current_b->id];
+                legs.back().move = move_b[super_current_b->id];
                 Node *temp_entry = entry_b[super_current_b->id];
                 super_current_b = last_b[super_current_b->id];
-                route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
             } while (super_current_b != super_target);
-            if (super_current_b != super_source)
-                do
-                {
-                    route.insert(0, 1, move_f[super_current_f->id]);
-                    Node *temp_exit = exit_f[super_current_f->id];
-                    super_current_f = last_f[super_current_f->id];
-                    route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-                } while (super_current_f != super_source);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -1946,7 +4290,7 @@ Lattice::Route Lattice::super_bdgbfs(Node *source, Node *target, const SearchMod
             exit_f[super_arc->next->id] = super_arc->exit;
             entry_f[super_arc->next->id] = super_arc->link->next;
             move_f[super_arc->next->id] = super_arc->link->move;
-            open_set_f.emplace(super_arc->next, heuristic_f(super_arc->link->next));
+            open_set_f.push({super_arc->next, heuristic_f(super_arc->link->next)});
         }
         focus_b = exit_b[super_current_b->id];
         for (SuperArc *super_arc : super_current_b->incomings) // (backwards)
@@ -1957,17 +4301,18 @@ Lattice::Route Lattice::super_bdgbfs(Node *source, Node *target, const SearchMod
             entry_b[super_arc->next->id] = super_arc->exit;
             exit_b[super_arc->next->id] = super_arc->link->next;
             move_b[super_arc->next->id] = super_arc->link->move;
-            open_set_b.emplace(super_arc->next, heuristic_b(super_arc->link->next));
+            open_set_b.push({super_arc->next, heuristic_b(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
         delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_ngbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_ngbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -1980,42 +4325,42 @@ Lattice::Route Lattice::super_ngbfs(Node *source, Node *target, const SearchMode
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMaxCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second < b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second > b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMaxCmp> open_set;
+    _2Ls::BoxBinaryHeap<Pair, PairMaxCmp, false> open_set(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_source;
         exit[super_arc->next->id] = super_arc->exit;
         entry[super_arc->next->id] = super_arc->link->next;
         move[super_arc->next->id] = super_arc->link->move;
-        open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+        open_set.push({super_arc->next, heuristic(super_arc->link->next)});
     }
 
     // search
     while (!open_set.empty())
     {
-        auto [super_current, key] = open_set.top(); // get next node
-        open_set.pop();
+        auto [super_current, key] = open_set.extract(); // get next node
 
         if (super_current == super_target) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             entry[super_source->id] = source;
-            Route route = (this->*algorithm)(entry[super_current->id], target);
-            do
+            reverse_chain(last, super_source, super_current);
+            for (SuperNode *super_hop = super_source; super_hop != super_current;)
             {
-                route.insert(0, 1, move[super_current->id]);
-                Node *temp_exit = exit[super_current->id];
-                super_current = last[super_current->id];
-                route.insert(0, (this->*algorithm)(entry[super_current->id], temp_exit));
-            } while (super_current != super_source);
+                SuperNode *super_next = last[super_hop->id];
+                legs.push_back({entry[super_hop->id], exit[super_next->id], move[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry[super_current->id], target, 0});
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -2027,16 +4372,17 @@ Lattice::Route Lattice::super_ngbfs(Node *source, Node *target, const SearchMode
             exit[super_arc->next->id] = super_arc->exit;
             entry[super_arc->next->id] = super_arc->link->next;
             move[super_arc->next->id] = super_arc->link->move;
-            open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+            open_set.push({super_arc->next, heuristic(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_rngbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_rngbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -2049,42 +4395,42 @@ Lattice::Route Lattice::super_rngbfs(Node *source, Node *target, const SearchMod
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMaxCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second < b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second > b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMaxCmp> open_set;
+    _2Ls::BoxBinaryHeap<Pair, PairMaxCmp, false> open_set(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_target->incomings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_target;
         entry[super_arc->next->id] = super_arc->exit;
         exit[super_arc->next->id] = super_arc->link->next;
         move[super_arc->next->id] = super_arc->link->move;
-        open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+        open_set.push({super_arc->next, heuristic(super_arc->link->next)});
     }
 
     // search
     while (!open_set.empty())
     {
-        auto [super_current, key] = open_set.top(); // get next node
-        open_set.pop();
+        auto [super_current, key] = open_set.extract(); // get next node
 
         if (super_current == super_source) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             exit[super_target->id] = target;
-            Route route = (this->*algorithm)(source, exit[super_current->id]);
+            legs.push_back({source, exit[super_current->id], 0});
             do
             {
-                route += move[super_current->id];
+                legs.back().move = move[super_current->id];
                 Node *temp_entry = entry[super_current->id];
                 super_current = last[super_current->id];
-                route += (this->*algorithm)(temp_entry, exit[super_current->id]);
+                legs.push_back({temp_entry, exit[super_current->id], 0});
             } while (super_current != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -2096,16 +4442,17 @@ Lattice::Route Lattice::super_rngbfs(Node *source, Node *target, const SearchMod
             entry[super_arc->next->id] = super_arc->exit;
             exit[super_arc->next->id] = super_arc->link->next;
             move[super_arc->next->id] = super_arc->link->move;
-            open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+            open_set.push({super_arc->next, heuristic(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_bdngbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_bdngbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -2125,26 +4472,30 @@ Lattice::Route Lattice::super_bdngbfs(Node *source, Node *target, const SearchMo
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMaxCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second < b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second > b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMaxCmp> open_set_f, open_set_b;
+    _2Ls::BoxBinaryHeap<Pair, PairMaxCmp, false> open_set_f(congraph.size()), open_set_b(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings) // (forwards)
     {
+        if (move_f[super_arc->next->id] != 0)
+            continue;
         last_f[super_arc->next->id] = super_source;
         exit_f[super_arc->next->id] = super_arc->exit;
         entry_f[super_arc->next->id] = super_arc->link->next;
         move_f[super_arc->next->id] = super_arc->link->move;
-        open_set_f.emplace(super_arc->next, heuristic_f(super_arc->link->next));
+        open_set_f.push({super_arc->next, heuristic_f(super_arc->link->next)});
     }
     for (SuperArc *super_arc : super_target->incomings) // (backwards)
     {
+        if (move_b[super_arc->next->id] != 0)
+            continue;
         last_b[super_arc->next->id] = super_target;
         entry_b[super_arc->next->id] = super_arc->exit;
         exit_b[super_arc->next->id] = super_arc->link->next;
         move_b[super_arc->next->id] = super_arc->link->move;
-        open_set_b.emplace(super_arc->next, heuristic_b(super_arc->link->next));
+        open_set_b.push({super_arc->next, heuristic_b(super_arc->link->next)});
     }
 
     // search
@@ -2153,66 +4504,61 @@ Lattice::Route Lattice::super_bdngbfs(Node *source, Node *target, const SearchMo
         if (open_set_f.empty())
             break;
 
-        std::tie(super_current_f, key_f) = open_set_f.top(); // get next super node (forwards)
-        open_set_f.pop();
+        std::tie(super_current_f, key_f) = open_set_f.extract(); // get next super node (forwards)
 
         if (entry_b[super_current_f->id] != nullptr) // goal check (forwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             super_current_b = super_current_f;
-            Route route = (this->*algorithm)(entry_f[super_current_f->id], exit_b[super_current_f->id]);
-            do
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
             {
-                route.insert(0, 1, move_f[super_current_f->id]);
-                Node *temp_exit = exit_f[super_current_f->id];
-                super_current_f = last_f[super_current_f->id];
-                route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-            } while (super_current_f != super_source);
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_f->id], exit_b[super_current_f->id], 0});
             if (super_current_b != super_target)
                 do
                 {
-                    route += move_b[super_current_b->id];
+                    legs.back().move = move_b[super_current_b->id];
                     Node *temp_entry = entry_b[super_current_b->id];
                     super_current_b = last_b[super_current_b->id];
-                    route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                    legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
                 } while (super_current_b != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         if (open_set_b.empty())
             break;
-        std::tie(super_current_b, key_b) = open_set_b.top(); // get next super node (backwards)
-        open_set_b.pop();
+        std::tie(super_current_b, key_b) = open_set_b.extract(); // get next super node (backwards)
 
         if (exit_f[super_current_b->id] != nullptr) // goal check (backwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             super_current_f = super_current_b;
-            Route route = (this->*algorithm)(entry_f[super_current_b->id], exit_b[super_current_b->id]);
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
+            {
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_b->id], exit_b[super_current_b->id], 0});
             do
             {
-                route += move_b[super_current_b->id];
+                legs.back().move = move_b[super_current_b->id];
                 Node *temp_entry = entry_b[super_current_b->id];
                 super_current_b = last_b[super_current_b->id];
-                route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
             } while (super_current_b != super_target);
-            if (super_current_b != super_source)
-                do
-                {
-                    route.insert(0, 1, move_f[super_current_f->id]);
-                    Node *temp_exit = exit_f[super_current_f->id];
-                    super_current_f = last_f[super_current_f->id];
-                    route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-                } while (super_current_f != super_source);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -2225,7 +4571,7 @@ Lattice::Route Lattice::super_bdngbfs(Node *source, Node *target, const SearchMo
             exit_f[super_arc->next->id] = super_arc->exit;
             entry_f[super_arc->next->id] = super_arc->link->next;
             move_f[super_arc->next->id] = super_arc->link->move;
-            open_set_f.emplace(super_arc->next, heuristic_f(super_arc->link->next));
+            open_set_f.push({super_arc->next, heuristic_f(super_arc->link->next)});
         }
         focus_b = exit_b[super_current_b->id];
         for (SuperArc *super_arc : super_current_b->incomings) // (backwards)
@@ -2236,17 +4582,18 @@ Lattice::Route Lattice::super_bdngbfs(Node *source, Node *target, const SearchMo
             entry_b[super_arc->next->id] = super_arc->exit;
             exit_b[super_arc->next->id] = super_arc->link->next;
             move_b[super_arc->next->id] = super_arc->link->move;
-            open_set_b.emplace(super_arc->next, heuristic_b(super_arc->link->next));
+            open_set_b.push({super_arc->next, heuristic_b(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
         delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_astar(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_astar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -2260,42 +4607,42 @@ Lattice::Route Lattice::super_astar(Node *source, Node *target, const SearchMode
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMinCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second > b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second < b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMinCmp> open_set;
+    _2Ls::BoxBinaryHeap<Pair, PairMinCmp, false> open_set(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_source;
         exit[super_arc->next->id] = super_arc->exit;
         entry[super_arc->next->id] = super_arc->link->next;
         move[super_arc->next->id] = super_arc->link->move;
-        open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+        open_set.push({super_arc->next, heuristic(super_arc->link->next)});
     }
 
     // search
     while (!open_set.empty())
     {
-        auto [super_current, key] = open_set.top(); // get next node
-        open_set.pop();
+        auto [super_current, key] = open_set.extract(); // get next node
 
         if (super_current == super_target) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             entry[super_source->id] = source;
-            Route route = (this->*algorithm)(entry[super_current->id], target);
-            do
+            reverse_chain(last, super_source, super_current);
+            for (SuperNode *super_hop = super_source; super_hop != super_current;)
             {
-                route.insert(0, 1, move[super_current->id]);
-                Node *temp_exit = exit[super_current->id];
-                super_current = last[super_current->id];
-                route.insert(0, (this->*algorithm)(entry[super_current->id], temp_exit));
-            } while (super_current != super_source);
+                SuperNode *super_next = last[super_hop->id];
+                legs.push_back({entry[super_hop->id], exit[super_next->id], move[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry[super_current->id], target, 0});
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -2307,16 +4654,17 @@ Lattice::Route Lattice::super_astar(Node *source, Node *target, const SearchMode
             exit[super_arc->next->id] = super_arc->exit;
             entry[super_arc->next->id] = super_arc->link->next;
             move[super_arc->next->id] = super_arc->link->move;
-            open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+            open_set.push({super_arc->next, heuristic(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_rastar(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_rastar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -2330,42 +4678,42 @@ Lattice::Route Lattice::super_rastar(Node *source, Node *target, const SearchMod
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMinCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second > b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second < b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMinCmp> open_set;
+    _2Ls::BoxBinaryHeap<Pair, PairMinCmp, false> open_set(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_target->incomings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_target;
         entry[super_arc->next->id] = super_arc->exit;
         exit[super_arc->next->id] = super_arc->link->next;
         move[super_arc->next->id] = super_arc->link->move;
-        open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+        open_set.push({super_arc->next, heuristic(super_arc->link->next)});
     }
 
     // search
     while (!open_set.empty())
     {
-        auto [super_current, key] = open_set.top(); // get next node
-        open_set.pop();
+        auto [super_current, key] = open_set.extract(); // get next node
 
         if (super_current == super_source) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             exit[super_target->id] = target;
-            Route route = (this->*algorithm)(source, exit[super_current->id]);
+            legs.push_back({source, exit[super_current->id], 0});
             do
             {
-                route += move[super_current->id];
+                legs.back().move = move[super_current->id];
                 Node *temp_entry = entry[super_current->id];
                 super_current = last[super_current->id];
-                route += (this->*algorithm)(temp_entry, exit[super_current->id]);
+                legs.push_back({temp_entry, exit[super_current->id], 0});
             } while (super_current != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -2377,16 +4725,17 @@ Lattice::Route Lattice::super_rastar(Node *source, Node *target, const SearchMod
             entry[super_arc->next->id] = super_arc->exit;
             exit[super_arc->next->id] = super_arc->link->next;
             move[super_arc->next->id] = super_arc->link->move;
-            open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+            open_set.push({super_arc->next, heuristic(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_bdastar(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_bdastar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -2408,26 +4757,30 @@ Lattice::Route Lattice::super_bdastar(Node *source, Node *target, const SearchMo
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMinCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second > b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second < b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMinCmp> open_set_f, open_set_b;
+    _2Ls::BoxBinaryHeap<Pair, PairMinCmp, false> open_set_f(congraph.size()), open_set_b(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings) // (forwards)
     {
+        if (move_f[super_arc->next->id] != 0)
+            continue;
         last_f[super_arc->next->id] = super_source;
         exit_f[super_arc->next->id] = super_arc->exit;
         entry_f[super_arc->next->id] = super_arc->link->next;
         move_f[super_arc->next->id] = super_arc->link->move;
-        open_set_f.emplace(super_arc->next, heuristic_f(super_arc->link->next));
+        open_set_f.push({super_arc->next, heuristic_f(super_arc->link->next)});
     }
     for (SuperArc *super_arc : super_target->incomings) // (backwards)
     {
+        if (move_b[super_arc->next->id] != 0)
+            continue;
         last_b[super_arc->next->id] = super_target;
         entry_b[super_arc->next->id] = super_arc->exit;
         exit_b[super_arc->next->id] = super_arc->link->next;
         move_b[super_arc->next->id] = super_arc->link->move;
-        open_set_b.emplace(super_arc->next, heuristic_b(super_arc->link->next));
+        open_set_b.push({super_arc->next, heuristic_b(super_arc->link->next)});
     }
 
     // search
@@ -2436,66 +4789,61 @@ Lattice::Route Lattice::super_bdastar(Node *source, Node *target, const SearchMo
         if (open_set_f.empty())
             break;
 
-        std::tie(super_current_f, key_f) = open_set_f.top(); // get next super node (forwards)
-        open_set_f.pop();
+        std::tie(super_current_f, key_f) = open_set_f.extract(); // get next super node (forwards)
 
         if (entry_b[super_current_f->id] != nullptr) // goal check (forwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             super_current_b = super_current_f;
-            Route route = (this->*algorithm)(entry_f[super_current_f->id], exit_b[super_current_f->id]);
-            do
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
             {
-                route.insert(0, 1, move_f[super_current_f->id]);
-                Node *temp_exit = exit_f[super_current_f->id];
-                super_current_f = last_f[super_current_f->id];
-                route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-            } while (super_current_f != super_source);
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_f->id], exit_b[super_current_f->id], 0});
             if (super_current_b != super_target)
                 do
                 {
-                    route += move_b[super_current_b->id];
+                    legs.back().move = move_b[super_current_b->id];
                     Node *temp_entry = entry_b[super_current_b->id];
                     super_current_b = last_b[super_current_b->id];
-                    route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                    legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
                 } while (super_current_b != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         if (open_set_b.empty())
             break;
-        std::tie(super_current_b, key_b) = open_set_b.top(); // get next super node (backwards)
-        open_set_b.pop();
+        std::tie(super_current_b, key_b) = open_set_b.extract(); // get next super node (backwards)
 
         if (exit_f[super_current_b->id] != nullptr) // goal check (backwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             super_current_f = super_current_b;
-            Route route = (this->*algorithm)(entry_f[super_current_b->id], exit_b[super_current_b->id]);
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
+            {
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_b->id], exit_b[super_current_b->id], 0});
             do
             {
-                route += move_b[super_current_b->id];
+                legs.back().move = move_b[super_current_b->id];
                 Node *temp_entry = entry_b[super_current_b->id];
                 super_current_b = last_b[super_current_b->id];
-                route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
             } while (super_current_b != super_target);
-            if (super_current_b != super_source)
-                do
-                {
-                    route.insert(0, 1, move_f[super_current_f->id]);
-                    Node *temp_exit = exit_f[super_current_f->id];
-                    super_current_f = last_f[super_current_f->id];
-                    route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-                } while (super_current_f != super_source);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -2508,7 +4856,7 @@ Lattice::Route Lattice::super_bdastar(Node *source, Node *target, const SearchMo
             exit_f[super_arc->next->id] = super_arc->exit;
             entry_f[super_arc->next->id] = super_arc->link->next;
             move_f[super_arc->next->id] = super_arc->link->move;
-            open_set_f.emplace(super_arc->next, heuristic_f(super_arc->link->next));
+            open_set_f.push({super_arc->next, heuristic_f(super_arc->link->next)});
         }
         focus_b = exit_b[super_current_b->id];
         for (SuperArc *super_arc : super_current_b->incomings) // (backwards)
@@ -2519,17 +4867,18 @@ Lattice::Route Lattice::super_bdastar(Node *source, Node *target, const SearchMo
             entry_b[super_arc->next->id] = super_arc->exit;
             exit_b[super_arc->next->id] = super_arc->link->next;
             move_b[super_arc->next->id] = super_arc->link->move;
-            open_set_b.emplace(super_arc->next, heuristic_b(super_arc->link->next));
+            open_set_b.push({super_arc->next, heuristic_b(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
         delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_nastar(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_nastar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -2543,42 +4892,42 @@ Lattice::Route Lattice::super_nastar(Node *source, Node *target, const SearchMod
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMaxCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second < b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second > b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMaxCmp> open_set;
+    _2Ls::BoxBinaryHeap<Pair, PairMaxCmp, false> open_set(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_source;
         exit[super_arc->next->id] = super_arc->exit;
         entry[super_arc->next->id] = super_arc->link->next;
         move[super_arc->next->id] = super_arc->link->move;
-        open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+        open_set.push({super_arc->next, heuristic(super_arc->link->next)});
     }
 
     // search
     while (!open_set.empty())
     {
-        auto [super_current, key] = open_set.top(); // get next node
-        open_set.pop();
+        auto [super_current, key] = open_set.extract(); // get next node
 
         if (super_current == super_target) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             entry[super_source->id] = source;
-            Route route = (this->*algorithm)(entry[super_current->id], target);
-            do
+            reverse_chain(last, super_source, super_current);
+            for (SuperNode *super_hop = super_source; super_hop != super_current;)
             {
-                route.insert(0, 1, move[super_current->id]);
-                Node *temp_exit = exit[super_current->id];
-                super_current = last[super_current->id];
-                route.insert(0, (this->*algorithm)(entry[super_current->id], temp_exit));
-            } while (super_current != super_source);
+                SuperNode *super_next = last[super_hop->id];
+                legs.push_back({entry[super_hop->id], exit[super_next->id], move[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry[super_current->id], target, 0});
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -2590,16 +4939,17 @@ Lattice::Route Lattice::super_nastar(Node *source, Node *target, const SearchMod
             exit[super_arc->next->id] = super_arc->exit;
             entry[super_arc->next->id] = super_arc->link->next;
             move[super_arc->next->id] = super_arc->link->move;
-            open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+            open_set.push({super_arc->next, heuristic(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_rnastar(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_rnastar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -2613,42 +4963,42 @@ Lattice::Route Lattice::super_rnastar(Node *source, Node *target, const SearchMo
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMaxCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second < b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second > b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMaxCmp> open_set;
+    _2Ls::BoxBinaryHeap<Pair, PairMaxCmp, false> open_set(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_target->incomings)
     {
+        if (move[super_arc->next->id] != 0)
+            continue;
         last[super_arc->next->id] = super_target;
         entry[super_arc->next->id] = super_arc->exit;
         exit[super_arc->next->id] = super_arc->link->next;
         move[super_arc->next->id] = super_arc->link->move;
-        open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+        open_set.push({super_arc->next, heuristic(super_arc->link->next)});
     }
 
     // search
     while (!open_set.empty())
     {
-        auto [super_current, key] = open_set.top(); // get next node
-        open_set.pop();
+        auto [super_current, key] = open_set.extract(); // get next node
 
         if (super_current == super_source) // goal check
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             exit[super_target->id] = target;
-            Route route = (this->*algorithm)(source, exit[super_current->id]);
+            legs.push_back({source, exit[super_current->id], 0});
             do
             {
-                route += move[super_current->id];
+                legs.back().move = move[super_current->id];
                 Node *temp_entry = entry[super_current->id];
                 super_current = last[super_current->id];
-                route += (this->*algorithm)(temp_entry, exit[super_current->id]);
+                legs.push_back({temp_entry, exit[super_current->id], 0});
             } while (super_current != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last, delete[] exit, delete[] entry, delete[] move;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -2660,16 +5010,17 @@ Lattice::Route Lattice::super_rnastar(Node *source, Node *target, const SearchMo
             entry[super_arc->next->id] = super_arc->exit;
             exit[super_arc->next->id] = super_arc->link->next;
             move[super_arc->next->id] = super_arc->link->move;
-            open_set.emplace(super_arc->next, heuristic(super_arc->link->next));
+            open_set.push({super_arc->next, heuristic(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last, delete[] exit, delete[] entry, delete[] move;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
-Lattice::Route Lattice::super_bdnastar(Node *source, Node *target, const SearchMode &sub_search_mode) const
+template <typename R>
+bool Lattice::super_bdnastar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const
 {
     // search meta data
     SuperNode *super_source = source->super, *super_target = target->super,
@@ -2691,26 +5042,30 @@ Lattice::Route Lattice::super_bdnastar(Node *source, Node *target, const SearchM
     using Pair = std::pair<SuperNode *, size_t>;
     struct PairMaxCmp
     {
-        bool operator()(const Pair &a, const Pair &b) { return a.second < b.second; }
+        bool operator()(const Pair &a, const Pair &b) const noexcept { return a.second > b.second; }
     };
-    std::priority_queue<Pair, std::vector<Pair>, PairMaxCmp> open_set_f, open_set_b;
+    _2Ls::BoxBinaryHeap<Pair, PairMaxCmp, false> open_set_f(congraph.size()), open_set_b(congraph.size());
 
     // track initial adjacencies
     for (SuperArc *super_arc : super_source->outgoings) // (forwards)
     {
+        if (move_f[super_arc->next->id] != 0)
+            continue;
         last_f[super_arc->next->id] = super_source;
         exit_f[super_arc->next->id] = super_arc->exit;
         entry_f[super_arc->next->id] = super_arc->link->next;
         move_f[super_arc->next->id] = super_arc->link->move;
-        open_set_f.emplace(super_arc->next, heuristic_f(super_arc->link->next));
+        open_set_f.push({super_arc->next, heuristic_f(super_arc->link->next)});
     }
     for (SuperArc *super_arc : super_target->incomings) // (backwards)
     {
+        if (move_b[super_arc->next->id] != 0)
+            continue;
         last_b[super_arc->next->id] = super_target;
         entry_b[super_arc->next->id] = super_arc->exit;
         exit_b[super_arc->next->id] = super_arc->link->next;
         move_b[super_arc->next->id] = super_arc->link->move;
-        open_set_b.emplace(super_arc->next, heuristic_b(super_arc->link->next));
+        open_set_b.push({super_arc->next, heuristic_b(super_arc->link->next)});
     }
 
     // search
@@ -2719,66 +5074,61 @@ Lattice::Route Lattice::super_bdnastar(Node *source, Node *target, const SearchM
         if (open_set_f.empty())
             break;
 
-        std::tie(super_current_f, key_f) = open_set_f.top(); // get next super node (forwards)
-        open_set_f.pop();
+        std::tie(super_current_f, key_f) = open_set_f.extract(); // get next super node (forwards)
 
         if (entry_b[super_current_f->id] != nullptr) // goal check (forwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             super_current_b = super_current_f;
-            Route route = (this->*algorithm)(entry_f[super_current_f->id], exit_b[super_current_f->id]);
-            do
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
             {
-                route.insert(0, 1, move_f[super_current_f->id]);
-                Node *temp_exit = exit_f[super_current_f->id];
-                super_current_f = last_f[super_current_f->id];
-                route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-            } while (super_current_f != super_source);
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_f->id], exit_b[super_current_f->id], 0});
             if (super_current_b != super_target)
                 do
                 {
-                    route += move_b[super_current_b->id];
+                    legs.back().move = move_b[super_current_b->id];
                     Node *temp_entry = entry_b[super_current_b->id];
                     super_current_b = last_b[super_current_b->id];
-                    route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                    legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
                 } while (super_current_b != super_target);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         if (open_set_b.empty())
             break;
-        std::tie(super_current_b, key_b) = open_set_b.top(); // get next super node (backwards)
-        open_set_b.pop();
+        std::tie(super_current_b, key_b) = open_set_b.extract(); // get next super node (backwards)
 
         if (exit_f[super_current_b->id] != nullptr) // goal check (backwards)
         {
-            Algorithm algorithm = get_algorithm(sub_search_mode);
-            if (algorithm == nullptr)
-                throw InvalidSearchMode(sub_search_mode);
+            std::vector<Leg> legs;
             super_current_f = super_current_b;
-            Route route = (this->*algorithm)(entry_f[super_current_b->id], exit_b[super_current_b->id]);
+            reverse_chain(last_f, super_source, super_current_f);
+            for (SuperNode *super_hop = super_source; super_hop != super_current_f;)
+            {
+                SuperNode *super_next = last_f[super_hop->id];
+                legs.push_back({entry_f[super_hop->id], exit_f[super_next->id], move_f[super_next->id]});
+                super_hop = super_next;
+            }
+            legs.push_back({entry_f[super_current_b->id], exit_b[super_current_b->id], 0});
             do
             {
-                route += move_b[super_current_b->id];
+                legs.back().move = move_b[super_current_b->id];
                 Node *temp_entry = entry_b[super_current_b->id];
                 super_current_b = last_b[super_current_b->id];
-                route += (this->*algorithm)(temp_entry, exit_b[super_current_b->id]);
+                legs.push_back({temp_entry, exit_b[super_current_b->id], 0});
             } while (super_current_b != super_target);
-            if (super_current_b != super_source)
-                do
-                {
-                    route.insert(0, 1, move_f[super_current_f->id]);
-                    Node *temp_exit = exit_f[super_current_f->id];
-                    super_current_f = last_f[super_current_f->id];
-                    route.insert(0, (this->*algorithm)(entry_f[super_current_f->id], temp_exit));
-                } while (super_current_f != super_source);
+            bool found = resolve_legs(legs, sub_search_mode, route, workspace);
             delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
                 delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-            return route;
+            return found;
         }
 
         // track current adjacencies
@@ -2791,7 +5141,7 @@ Lattice::Route Lattice::super_bdnastar(Node *source, Node *target, const SearchM
             exit_f[super_arc->next->id] = super_arc->exit;
             entry_f[super_arc->next->id] = super_arc->link->next;
             move_f[super_arc->next->id] = super_arc->link->move;
-            open_set_f.emplace(super_arc->next, heuristic_f(super_arc->link->next));
+            open_set_f.push({super_arc->next, heuristic_f(super_arc->link->next)});
         }
         focus_b = exit_b[super_current_b->id];
         for (SuperArc *super_arc : super_current_b->incomings) // (backwards)
@@ -2802,80 +5152,80 @@ Lattice::Route Lattice::super_bdnastar(Node *source, Node *target, const SearchM
             entry_b[super_arc->next->id] = super_arc->exit;
             exit_b[super_arc->next->id] = super_arc->link->next;
             move_b[super_arc->next->id] = super_arc->link->move;
-            open_set_b.emplace(super_arc->next, heuristic_b(super_arc->link->next));
+            open_set_b.push({super_arc->next, heuristic_b(super_arc->link->next)});
         }
     }
 
     // when no path is found
     delete[] last_f, delete[] exit_f, delete[] entry_f, delete[] move_f,
         delete[] last_b, delete[] exit_b, delete[] entry_b, delete[] move_b;
-    throw Untraversable(source->position, target->position);
+    return false;
 }
 
 bool Lattice::verify(const SearchMode &search_mode) const
 {
-    Algorithm algorithm = get_algorithm(search_mode);
+    Algorithm algorithm = get_algorithm<Route>(search_mode);
     if (algorithm == nullptr)
         throw InvalidSearchMode(search_mode);
-    for (auto &[sp, sn] : graph)
-    {
-        for (auto &[tp, tn] : graph)
-        {
-            Route route;
-            try
-            {
-                route = (this->*algorithm)(sn, tn);
-            }
-            catch (const std::exception &e)
-            {
-                continue;
-            }
-            if (travel(sp, route) != tp)
-            {
-                LOG << sp << tp;
-                return false;
-            }
-        }
-    }
-    return true;
+    std::atomic<bool> failed(false);
+    std::mutex log_lock;
+    parallel_for(*this, tasks(), nodes.size(), 1, 0, [&](const size_t &i, Workspace &workspace) -> void
+                 {
+                     Node *sn = nodes[i];
+                     for (Node *tn : nodes)
+                     {
+                         if (failed.load(std::memory_order_relaxed))
+                             return;
+                         Route route;
+                         if (!(this->*algorithm)(sn, tn, route, workspace))
+                             continue;
+                         if (travel(sn->position, route) != tn->position)
+                         {
+                             std::lock_guard<std::mutex> lock(log_lock);
+                             if (!failed.exchange(true))
+                                 LOG << sn->position << tn->position;
+                             return;
+                         }
+                     } });
+    return !failed.load();
 }
 
 bool Lattice::super_verify(const SearchMode &super_search_mode,
                            const SearchMode &sub_search_mode) const
 {
-    SuperAlgorithm super_algorithm = get_super_algorithm(super_search_mode);
+    SuperAlgorithm super_algorithm = get_super_algorithm<Route>(super_search_mode);
     if (super_algorithm == nullptr)
         throw InvalidSearchMode(super_search_mode);
 
-    Algorithm algorithm = get_algorithm(sub_search_mode);
+    Algorithm algorithm = get_algorithm<Route>(sub_search_mode);
     if (algorithm == nullptr)
         throw InvalidSearchMode(sub_search_mode);
 
-    for (SuperNode *super1 : congraph)
-    {
-        if (super1->internals.size() == 2) // ignore windows in bastion
-            continue;
-        for (SuperNode *super2 : congraph)
-        {
-            if (super2->internals.size() == 2) // ignore windows in bastion
-                continue;
-            Node *sn = super1->internals.front(),
-                 *tn = super2->internals.back();
-            Route route;
-            try
-            {
-                route = (this->*super_algorithm)(sn, tn, sub_search_mode);
-            }
-            catch (const std::exception &e)
-            {
-                continue;
-            }
-            if (travel(sn->position, route) != tn->position)
-            {
-                LOG << sn->position << tn->position;
-                return false;
-            }
-        }
-    }
-    return true;
+    std::atomic<bool> failed(false);
+    std::mutex log_lock;
+    parallel_for(*this, tasks(), congraph.size(), 1, 0, [&](const size_t &i, Workspace &workspace) -> void
+                 {
+                     SuperNode *super1 = congraph[i];
+                     if (super1->internals.size() == 2) // ignore windows in bastion
+                         return;
+                     for (SuperNode *super2 : congraph)
+                     {
+                         if (super2->internals.size() == 2) // ignore windows in bastion
+                             continue;
+                         if (failed.load(std::memory_order_relaxed))
+                             return;
+                         Node *sn = super1->internals.front(),
+                              *tn = super2->internals.back();
+                         Route route;
+                         if (!(this->*super_algorithm)(sn, tn, sub_search_mode, route, workspace))
+                             continue;
+                         if (travel(sn->position, route) != tn->position)
+                         {
+                             std::lock_guard<std::mutex> lock(log_lock);
+                             if (!failed.exchange(true))
+                                 LOG << sn->position << tn->position;
+                             return;
+                         }
+                     } });
+    return !failed.load();
 }
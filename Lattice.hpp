@@ -3,37 +3,87 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "ConstantExpressions.hpp"
 #include "Coordinate.hpp"
 #include "TripPlan.hpp"
+#include "PackedRoute.hpp"
 #include "LatticeErrors.hpp"
-// todo #include "BoxStack.hpp"
-// todo #include "BoxQueue.hpp"
-// todo #include "BoxBinaryHeap.hpp"
+#include "BoxStack.hpp"
+#include "BoxQueue.hpp"
+#include "BoxBinaryHeap.hpp"
+#include "TaskScheduler.hpp"
 
 class Lattice
 {
 public:
     enum SearchMode : char;
+    enum SearchStatus : char;
     struct Node;
     struct Arc;
     struct SuperNode;
     struct SuperArc;
+    static constexpr size_t unreachable = SIZE_MAX; // distance between disconnected nodes
     using FilePath = std::string;
     using Move = char;
     using Route = std::string;
     class MetaData;
-    using Algorithm = Route (Lattice::*)(Lattice::Node *source, Lattice::Node *target) const;
-    using SuperAlgorithm = Route (Lattice::*)(Lattice::Node *source, Lattice::Node *target,
-                                              const SearchMode &sub_search_mode) const;
+    class Levels;
+    class Workspace;
+    class FlowField;
+    class FlowFieldCache;
+    class SourceTree;
+    class SourceTreeCache;
+    class RouteCache;
+    class PortalMemo;
+    struct RouteCacheStats
+    {
+        size_t hits, misses, evictions, bytes;
+    };
+    struct WorldProfile
+    {
+        size_t node_count = 0, arc_count = 0;
+        size_t component_count = 0, largest_component = 0; // 0 until condense()
+        double branching_factor = 0;                       // outgoings per node
+    };
+    template <typename R> // algorithms append their route to R and return false when there is none
+    using AlgorithmOf = bool (Lattice::*)(Lattice::Node *source, Lattice::Node *target, R &route,
+                                          Workspace &workspace) const;
+    using Algorithm = AlgorithmOf<Route>;
+    template <typename R>
+    using SuperAlgorithmOf = bool (Lattice::*)(Lattice::Node *source, Lattice::Node *target,
+                                               const SearchMode &sub_search_mode, R &route,
+                                               Workspace &workspace) const;
+    using SuperAlgorithm = SuperAlgorithmOf<Route>;
 
 private:
     FilePath origin_file_path;
     int x_size, y_size, z_size;
     size_t area_size, volume_size;
     std::unordered_map<Coordinate, Lattice::Node *, CoordinateHash> graph; // Node map
+    std::vector<Lattice::Node *> nodes;                                    // Node list by id
     std::vector<Lattice::SuperNode *> congraph;                            // Supernode List
+    bool compact_state = false; // 2-bit moves instead of parent pointers in search state
+    std::shared_ptr<FlowFieldCache> flow_fields;                           // Flow fields by target
+    std::shared_ptr<SourceTreeCache> source_trees;                         // BFS trees of hot sources
+    std::shared_ptr<RouteCache> routes;                                    // Routes of repeated queries
+    std::shared_ptr<_2Ls::TaskScheduler> scheduler;                        // Threads of every parallel feature
+    static constexpr size_t near_distance = 16, far_distance = 64, distance_classes = 3;
+    static constexpr double open_branching_factor = 3.95; // nearly every node has all four neighbours
+    static constexpr double super_largest_share = 0.5;    // past it one component is most of the world
+    WorldProfile profile;                                                   // Features AUTO decides on
+    SearchMode auto_modes[2 * distance_classes] = {};                       // AUTO's pick per query class
+    bool auto_goes_super = false;                                           // AUTO super searches condense
 
 public:
     Lattice(const FilePath &file_path);                     // Parameterized constructor // todo handle bad parse
@@ -46,59 +96,232 @@ public:
 
     size_t node_count() const noexcept { return graph.size(); }
     size_t super_node_count() const noexcept { return congraph.size(); }
+    void set_compact_state(const bool &compact) noexcept { compact_state = compact; }
     Coordinate travel(const Coordinate &source, const Route &route) const;
+    Coordinate travel(const Coordinate &source, const PackedRoute &route) const;
     void condense() noexcept;
     Route search(const TripPlan &trip_plan, const SearchMode &search_mode) const;
     Route super_search(const TripPlan &trip_plan,
                        const SearchMode &super_search_mode,
                        const SearchMode &sub_search_mode) const;
+    size_t search(const TripPlan &trip_plan, const SearchMode &search_mode, PackedRoute &route) const;
+    size_t super_search(const TripPlan &trip_plan,
+                        const SearchMode &super_search_mode,
+                        const SearchMode &sub_search_mode,
+                        PackedRoute &route) const;
+    SearchStatus try_search(const TripPlan &trip_plan, const SearchMode &search_mode, Route &route) const;
+    SearchStatus try_search(const TripPlan &trip_plan, const SearchMode &search_mode, PackedRoute &route) const;
+    SearchStatus try_super_search(const TripPlan &trip_plan,
+                                  const SearchMode &super_search_mode,
+                                  const SearchMode &sub_search_mode,
+                                  Route &route) const;
+    SearchStatus try_super_search(const TripPlan &trip_plan,
+                                  const SearchMode &super_search_mode,
+                                  const SearchMode &sub_search_mode,
+                                  PackedRoute &route) const;
+    void search_batch(const TripPlan trip_plans[], const size_t &count, const SearchMode &search_mode,
+                      SearchStatus statuses[], Route routes[], const size_t &threads = 0) const;
+    void search_batch(const TripPlan trip_plans[], const size_t &count, const SearchMode &search_mode,
+                      SearchStatus statuses[], PackedRoute routes[], const size_t &threads = 0) const;
+    void distance_matrix(const Coordinate sources[], const size_t &source_count,
+                         const Coordinate targets[], const size_t &target_count,
+                         SearchStatus statuses[], size_t distances[], const size_t &threads = 1) const;
+    void routes_from(const Coordinate &source, const Coordinate targets[], const size_t &target_count,
+                     SearchStatus statuses[], Route routes[]) const;
+    void routes_from(const Coordinate &source, const Coordinate targets[], const size_t &target_count,
+                     SearchStatus statuses[], PackedRoute routes[]) const;
+    Route search_nearest(const Coordinate &source, const Coordinate targets[], const size_t &target_count,
+                         const SearchMode &search_mode, size_t &nearest) const;
+    SearchStatus try_search_nearest(const Coordinate &source, const Coordinate targets[],
+                                    const size_t &target_count, const SearchMode &search_mode,
+                                    size_t &nearest, Route &route) const;
+    SearchStatus try_search_nearest(const Coordinate &source, const Coordinate targets[],
+                                    const size_t &target_count, const SearchMode &search_mode,
+                                    size_t &nearest, PackedRoute &route) const;
+    std::shared_ptr<const FlowField> build_flow_field(const Coordinate &target) const;
+    void set_flow_field_budget(const size_t &bytes);
+    size_t flow_distance(const FlowField &field, const Coordinate &source) const;
+    SearchStatus try_follow_flow_field(const FlowField &field, const Coordinate &source, Route &route) const;
+    SearchStatus try_follow_flow_field(const FlowField &field, const Coordinate &source,
+                                       PackedRoute &route) const;
+    SearchStatus try_flow_search(const TripPlan &trip_plan, Route &route) const;
+    SearchStatus try_flow_search(const TripPlan &trip_plan, PackedRoute &route) const;
+    void set_source_tree_budget(const size_t &bytes); // 0 turns the source tree cache off
+    size_t distance(const TripPlan &trip_plan, const SearchMode &search_mode) const;
+    bool reachable(const TripPlan &trip_plan) const;
+    void set_route_cache_budget(const size_t &bytes); // 0, the default, turns the route cache off
+    const WorldProfile &world_profile() const noexcept { return profile; }
+    void calibrate_auto_mode(const size_t &samples = 32);
+    SearchMode auto_mode(const TripPlan &trip_plan) const; // what AUTO would run for trip_plan
+    Route search_race(const TripPlan &trip_plan, const std::vector<SearchMode> &search_modes,
+                      SearchMode &winner) const;
+    SearchStatus try_search_race(const TripPlan &trip_plan, const std::vector<SearchMode> &search_modes,
+                                 SearchMode &winner, Route &route) const;
+    SearchStatus try_search_race(const TripPlan &trip_plan, const std::vector<SearchMode> &search_modes,
+                                 SearchMode &winner, PackedRoute &route) const;
+    std::vector<bool> reachable_within(const Coordinate &source, const size_t &k,
+                                       const size_t &threads = 1) const; // indexed by node_id
+    std::vector<bool> reachable_region(const Coordinate &source, const size_t &threads = 1) const;
+    std::vector<Coordinate> region_positions(const std::vector<bool> &region) const;
+    size_t node_id(const Coordinate &position) const;
+    RouteCacheStats route_cache_stats() const;
+    void set_thread_count(const size_t &threads, const bool &pin_threads = false); // 0 for every hardware thread
+    size_t thread_count() const noexcept;
     bool verify(const SearchMode &search_mode) const;
     bool super_verify(const SearchMode &super_search_mode,
                       const SearchMode &sub_search_mode) const;
 
 private:
     void tarjan_dfs(Node *u, int visit_time[], int low_link[], bool is_on_stack[],
-                    std::stack<Node *> &stack, int &current_time, id_t &id) noexcept;
-    Algorithm get_algorithm(const SearchMode &search_mode) const noexcept;
-    SuperAlgorithm get_super_algorithm(const SearchMode &search_mode) const noexcept;
+                    _2Ls::BoxStack<Node *, false> &stack, int &current_time, id_t &id) noexcept;
+    template <typename R>
+    SearchStatus try_search_as(const TripPlan &trip_plan, const SearchMode &search_mode, R &route,
+                               Workspace &workspace) const;
+    template <typename R>
+    SearchStatus try_super_search_as(const TripPlan &trip_plan,
+                                     const SearchMode &super_search_mode,
+                                     const SearchMode &sub_search_mode,
+                                     R &route, Workspace &workspace) const;
+    template <typename R>
+    void search_batch_as(const TripPlan trip_plans[], const size_t &count, const SearchMode &search_mode,
+                         SearchStatus statuses[], R routes[], size_t threads) const;
+    template <typename R>
+    void routes_from_as(const Coordinate &source, const Coordinate targets[], const size_t &target_count,
+                        SearchStatus statuses[], R routes[]) const;
+    bool expand_to_targets(Node *source, const std::vector<bool> &is_target, size_t pending,
+                           Workspace &workspace) const;
+    template <typename R>
+    SearchStatus try_search_nearest_as(const Coordinate &source, const Coordinate targets[],
+                                       const size_t &target_count, const SearchMode &search_mode,
+                                       size_t &nearest, R &route) const;
+    template <typename R>
+    Node *nearest_target(Node *source, const std::vector<Node *> &targets, const std::vector<bool> &is_target,
+                         const SearchMode &search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    Node *bidirectional_nearest_target(Node *source, const std::vector<Node *> &targets,
+                                       const std::vector<bool> &is_target, const SearchMode &search_mode,
+                                       R &route, Workspace &workspace) const;
+    template <typename R>
+    SearchStatus try_follow_flow_field_as(const FlowField &field, const Coordinate &source, R &route) const;
+    std::shared_ptr<const SourceTree> build_source_tree(Node *source) const;
+    bool reachable(Node *source, Node *target) const;
+    std::vector<bool> flood(Node *source, const size_t &k, size_t threads) const;
+    void profile_world() noexcept;
+    _2Ls::TaskScheduler &tasks() const noexcept;
+    size_t query_class(const Node *source, const Node *target) const noexcept;
+    SearchMode choose_mode(const Node *source, const Node *target) const noexcept;
+    void expand_levels(Node *source, Node *target, const size_t &k, size_t threads, Levels &levels,
+                       const std::atomic<bool> *stop) const;
+    template <typename R>
+    SearchStatus try_search_race_as(const TripPlan &trip_plan, const std::vector<SearchMode> &search_modes,
+                                    SearchMode &winner, R &route) const;
+    template <typename R>
+    bool retrace_source_tree(const SourceTree &tree, Node *target, R &route) const;
+    template <typename R>
+    AlgorithmOf<R> get_algorithm(const SearchMode &search_mode) const noexcept;
+    template <typename R>
+    SuperAlgorithmOf<R> get_super_algorithm(const SearchMode &search_mode) const noexcept;
 
-    Route dfs(Node *source, Node *target) const;
-    Route rdfs(Node *source, Node *target) const;
-    Route bddfs(Node *source, Node *target) const;
-    Route bfs(Node *source, Node *target) const;
-    Route rbfs(Node *source, Node *target) const;
-    Route bdbfs(Node *source, Node *target) const;
-    Route gbfs(Node *source, Node *target) const;
-    Route rgbfs(Node *source, Node *target) const;
-    Route bdgbfs(Node *source, Node *target) const;
-    Route ngbfs(Node *source, Node *target) const;
-    Route rngbfs(Node *source, Node *target) const;
-    Route bdngbfs(Node *source, Node *target) const;
-    Route astar(Node *source, Node *target) const;
-    Route rastar(Node *source, Node *target) const;
-    Route bdastar(Node *source, Node *target) const;
-    Route nastar(Node *source, Node *target) const;
-    Route rnastar(Node *source, Node *target) const;
-    Route bdnastar(Node *source, Node *target) const;
+    template <typename R>
+    bool dfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool rdfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool bddfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool bfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool rbfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool bdbfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool gbfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool rgbfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool bdgbfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool ngbfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool rngbfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool bdngbfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool astar(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool rastar(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool bdastar(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool nastar(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool rnastar(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool bdnastar(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool pbddfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool pbdbfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool pbdgbfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool pbdngbfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool pbdastar(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool pbdnastar(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool dobfs(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool hdastar(Node *source, Node *target, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool parallel_bidirectional(Node *source, Node *target, const SearchMode &one_way, R &route,
+                                Workspace &workspace) const;
 
-    Route super_dfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_rdfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_bddfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_bfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_rbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_bdbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_gbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_rgbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_bdgbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_ngbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_rngbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_bdngbfs(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_astar(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_rastar(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_bdastar(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_nastar(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_rnastar(Node *source, Node *target, const SearchMode &sub_search_mode) const;
-    Route super_bdnastar(Node *source, Node *target, const SearchMode &sub_search_mode) const;
+    struct Leg // stretch of a super route inside one component
+    {
+        Node *entry, *exit;
+        Move move; // crossing into the next component, 0 after the last leg
+    };
+    template <typename R>
+    bool resolve_legs(std::vector<Leg> &legs, const SearchMode &sub_search_mode, R &route,
+                      Workspace &workspace) const;
+    template <typename R>
+    bool super_dfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_rdfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_bddfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_bfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_rbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_bdbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_gbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_rgbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_bdgbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_ngbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_rngbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_bdngbfs(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_astar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_rastar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_bdastar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_nastar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_rnastar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
+    template <typename R>
+    bool super_bdnastar(Node *source, Node *target, const SearchMode &sub_search_mode, R &route, Workspace &workspace) const;
 };
 
 enum Lattice::SearchMode : char
@@ -121,6 +344,25 @@ enum Lattice::SearchMode : char
     NEGATIVE_A_STAR, // Max-Heap A* Search
     REVERSE_NEGATIVE_A_STAR,
     BIDIRECTIONAL_NEGATIVE_A_STAR,
+    PARALLEL_BIDIRECTIONAL_DFS, // forward and backward sides on their own threads
+    PARALLEL_BIDIRECTIONAL_BFS,
+    PARALLEL_BIDIRECTIONAL_GBFS,
+    PARALLEL_BIDIRECTIONAL_NEGATIVE_GBFS,
+    PARALLEL_BIDIRECTIONAL_A_STAR,
+    PARALLEL_BIDIRECTIONAL_NEGATIVE_A_STAR,
+    DIRECTION_OPTIMIZING_BFS, // level-synchronous multi-threaded BFS for very large worlds
+    HASH_DISTRIBUTED_A_STAR,  // A* with nodes split between threads by hashing their ids
+    AUTO,                     // picked per query from the world profile and calibration
+};
+
+enum Lattice::SearchStatus : char
+{
+    FOUND,
+    UNTRAVERSABLE, // no route from source to target
+    INVALID_SOURCE,
+    INVALID_TARGET,
+    INVALID_SEARCH_MODE,
+    INVALID_SUB_SEARCH_MODE,
 };
 
 #endif
@@ -0,0 +1,208 @@
+#ifndef PACKEDROUTE_HPP
+#define PACKEDROUTE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "LatticeErrors.hpp"
+
+// Route with 2 bits per move, 32 moves per word, in the order n s e w. Like the Box containers it
+// can run on a caller-owned buffer, in which case it never allocates and throws when it is full.
+struct PackedRoute
+{
+    struct Run
+    {
+        char move;
+        uint32_t count;
+    };
+
+private:
+    uint64_t *words;
+    size_t length, max_length;
+    bool owner;
+
+public:
+    static constexpr size_t moves_per_word = 32;
+    static constexpr size_t words_for(const size_t &moves) noexcept { return (moves + moves_per_word - 1) / moves_per_word; }
+    static uint64_t encode(const char &move, const size_t &index)
+    {
+        switch (move)
+        {
+        case 'n':
+            return 0;
+        case 's':
+            return 1;
+        case 'e':
+            return 2;
+        case 'w':
+            return 3;
+        }
+        throw InvalidRoute(move, index);
+    }
+    static char decode(const uint64_t &code) noexcept { return "nsew"[code & 3]; }
+
+    PackedRoute(const size_t &capacity = 0, uint64_t buffer[] = nullptr)
+        : words(buffer ? buffer : (capacity ? new uint64_t[words_for(capacity)] : nullptr)),
+          length(0), max_length(buffer ? capacity : words_for(capacity) * moves_per_word),
+          owner(buffer == nullptr) {} // Parameterized constructor
+    explicit PackedRoute(const std::string &route) : PackedRoute(route.size())
+    {
+        for (const char &move : route)
+            push_back(move);
+    } // Text constructor
+    PackedRoute(const PackedRoute &other) : PackedRoute(other.length)
+    {
+        std::copy(other.words, other.words + words_for(other.length), words);
+        length = other.length;
+    } // Copy constructor
+    PackedRoute(PackedRoute &&other) noexcept
+        : words(other.words), length(other.length), max_length(other.max_length), owner(other.owner)
+    {
+        other.words = nullptr, other.length = 0, other.max_length = 0, other.owner = true;
+    } // Move constructor
+    // A route on a caller's buffer keeps it: the moves are copied in, and a route that does not
+    // fit throws before anything is overwritten. Only owning routes trade buffers.
+    PackedRoute &operator=(const PackedRoute &other)
+    {
+        if (this == &other)
+            return *this;
+        if (!owner)
+            return assign(other);
+        PackedRoute temp(other);
+        swap(temp);
+        return *this;
+    } // Copy assignment
+    PackedRoute &operator=(PackedRoute &&other)
+    {
+        if (this == &other)
+            return *this;
+        if (!owner || !other.owner)
+            return assign(other);
+        swap(other);
+        return *this;
+    }                                                       // Move assignment
+    ~PackedRoute() noexcept { release(); }                  // Default destructor
+
+    size_t size() const noexcept { return length; }
+    size_t capacity() const noexcept { return max_length; }
+    bool empty() const noexcept { return length == 0; }
+    const uint64_t *data() const noexcept { return words; }
+    size_t word_count() const noexcept { return words_for(length); }
+
+    char operator[](const size_t &index) const noexcept
+    {
+        return decode(words[index / moves_per_word] >> (index % moves_per_word * 2));
+    }
+    void push_back(const char &move)
+    {
+        uint64_t code = encode(move, length);
+        if (length == max_length)
+            grow(length + 1);
+        size_t word = length / moves_per_word, shift = length % moves_per_word * 2;
+        words[word] = (shift ? words[word] & ~(uint64_t(3) << shift) : 0) | code << shift;
+        ++length;
+    }
+    PackedRoute &operator+=(const char &move) { return push_back(move), *this; }
+    PackedRoute &operator+=(const PackedRoute &other)
+    {
+        size_t other_length = other.length; // other may be *this
+        reserve(length + other_length);
+        for (size_t i = 0; i < other_length; ++i)
+            push_back(other[i]);
+        return *this;
+    }
+    void reserve(const size_t &moves)
+    {
+        if (moves > max_length)
+            grow(moves);
+    }
+    void clear() noexcept { length = 0; }
+    void reverse(size_t first, size_t last) noexcept
+    {
+        while (first + 1 < last)
+        {
+            char move = (*this)[first];
+            set(first++, (*this)[--last]);
+            set(last, move);
+        }
+    }
+
+    std::string to_string() const
+    {
+        std::string route(length, '\0');
+        for (size_t i = 0; i < length; ++i)
+            route[i] = (*this)[i];
+        return route;
+    }
+    friend std::ostream &operator<<(std::ostream &s, const PackedRoute &route)
+    {
+        return s << route.to_string();
+    }
+
+    // run-length form (n x12, e x3, ...) for payloads dominated by straight corridors;
+    // writes at most max_runs runs and returns how many the whole route needs
+    size_t run_length_encode(Run runs[], const size_t &max_runs) const noexcept
+    {
+        size_t count = 0;
+        for (size_t i = 0; i < length; ++i)
+        {
+            char move = (*this)[i];
+            if (count != 0 && move == (*this)[i - 1])
+            {
+                if (count <= max_runs)
+                    ++runs[count - 1].count;
+            }
+            else if (count++ < max_runs)
+                runs[count - 1] = {move, 1};
+        }
+        return count;
+    }
+    void run_length_decode(const Run runs[], const size_t &run_count)
+    {
+        clear();
+        for (size_t r = 0; r < run_count; ++r)
+            for (uint32_t i = 0; i < runs[r].count; ++i)
+                push_back(runs[r].move);
+    }
+
+private:
+    PackedRoute &assign(const PackedRoute &other)
+    {
+        reserve(other.length);
+        clear();
+        return *this += other;
+    }
+    void set(const size_t &index, const char &move) noexcept
+    {
+        size_t word = index / moves_per_word, shift = index % moves_per_word * 2;
+        words[word] = (words[word] & ~(uint64_t(3) << shift)) | encode(move, index) << shift;
+    }
+    void grow(const size_t &moves)
+    {
+        if (!owner)
+            throw std::length_error("PackedRoute::push_back caller buffer full");
+        size_t new_max_length = std::max(max_length ? 2 * max_length : 4 * moves_per_word,
+                                         words_for(moves) * moves_per_word);
+        uint64_t *new_words = new uint64_t[words_for(new_max_length)];
+        std::copy(words, words + words_for(length), new_words);
+        delete[] words;
+        words = new_words, max_length = new_max_length;
+    }
+    void swap(PackedRoute &other) noexcept
+    {
+        std::swap(words, other.words);
+        std::swap(length, other.length);
+        std::swap(max_length, other.max_length);
+        std::swap(owner, other.owner);
+    }
+    void release() noexcept
+    {
+        if (owner)
+            delete[] words;
+        words = nullptr;
+    }
+};
+
+#endif
@@ -0,0 +1,266 @@
+#ifndef TASKSCHEDULER_HPP
+#define TASKSCHEDULER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace _2Ls
+{
+    // Work-stealing fork-join pool. Every worker owns a deque it pushes to and pops from at the
+    // back, and a worker that runs dry steals from the front of the others. Slot 0 belongs to the
+    // threads outside the pool. A thread waiting on a task group runs queued tasks while there are
+    // any and only sleeps once the rest of the group is running elsewhere, so groups nest freely
+    // and a pool of one thread, the caller, still makes progress. Workers start with the first
+    // task submitted, so a pool nobody forks on costs no threads.
+    class TaskScheduler
+    {
+        struct Deque
+        {
+            std::mutex lock;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<Deque>> deques;
+        std::vector<std::thread> workers;
+        std::once_flag started;
+        bool pinned;
+        std::mutex sleep_lock;
+        std::condition_variable wake;
+        std::atomic<size_t> queued{0};
+        std::atomic<bool> stopping{false};
+        inline static thread_local const TaskScheduler *current = nullptr;
+        inline static thread_local size_t current_slot = 0;
+
+    public:
+        // Tasks forked from one place and joined together. The first exception a task throws is
+        // rethrown by wait().
+        class TaskGroup
+        {
+            TaskScheduler &scheduler;
+            std::atomic<size_t> pending{0};
+            std::exception_ptr failure;
+            std::mutex failure_lock;
+
+        public:
+            TaskGroup(TaskScheduler &scheduler) noexcept : scheduler(scheduler) {} // Parameterized constructor
+            TaskGroup(const TaskGroup &) = delete;                                 // Copy constructor
+            TaskGroup(TaskGroup &&) = delete;                                      // Move constructor
+            TaskGroup &operator=(const TaskGroup &) = delete;                      // Copy assignment
+            TaskGroup &operator=(TaskGroup &&) = delete;                           // Move assignment
+            ~TaskGroup() noexcept { join(); } // Default destructor
+
+            template <typename Task>
+            void run(Task &&task)
+            {
+                pending.fetch_add(1, std::memory_order_relaxed);
+                scheduler.submit([this, task = std::forward<Task>(task)]() mutable -> void
+                                 {
+                                     TaskScheduler &pool = scheduler; // the group may be gone once pending is 0
+                                     try
+                                     {
+                                         task();
+                                     }
+                                     catch (...)
+                                     {
+                                         std::lock_guard<std::mutex> lock(failure_lock);
+                                         if (!failure)
+                                             failure = std::current_exception();
+                                     }
+                                     if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                                         pool.notify_waiters(); });
+            }
+            void wait()
+            {
+                join();
+                if (failure)
+                {
+                    std::exception_ptr rethrown = failure;
+                    failure = nullptr;
+                    std::rethrow_exception(rethrown);
+                }
+            }
+
+        private:
+            void join() noexcept
+            {
+                while (pending.load(std::memory_order_acquire) != 0)
+                    if (!scheduler.run_one())
+                        scheduler.sleep_until([this]() -> bool
+                                              { return pending.load(std::memory_order_acquire) == 0; });
+            }
+        };
+
+        // threads counts the caller, so threads - 1 workers are started; 0 uses every hardware
+        // thread. pin_threads binds worker i to core i where the platform allows it.
+        TaskScheduler(size_t threads = 0, const bool &pin_threads = false) : pinned(pin_threads)
+        {
+            if (threads == 0)
+                threads = std::max(std::thread::hardware_concurrency(), 1u);
+            for (size_t slot = 0; slot < threads; ++slot)
+                deques.emplace_back(new Deque);
+        } // Parameterized constructor
+        TaskScheduler(const TaskScheduler &) = delete;            // Copy constructor
+        TaskScheduler(TaskScheduler &&) = delete;                 // Move constructor
+        TaskScheduler &operator=(const TaskScheduler &) = delete; // Copy assignment
+        TaskScheduler &operator=(TaskScheduler &&) = delete;      // Move assignment
+        ~TaskScheduler() noexcept
+        {
+            {
+                std::lock_guard<std::mutex> lock(sleep_lock);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (std::thread &worker : workers)
+                worker.join();
+        } // Default destructor
+
+        size_t thread_count() const noexcept { return deques.size(); }
+
+        // Runs task(first, last, slot) over chunks of grain indices below count on at most slots
+        // tasks (0 for one per thread). Each task claims chunks from a shared counter until they
+        // run out, and slot numbers the task, not the thread running it, so per-slot state is
+        // never shared. The caller runs slot 0, and the first exception stops handing out chunks
+        // and is rethrown here.
+        template <typename Task>
+        void parallel_chunks(const size_t &count, const size_t &grain, size_t slots, const Task &task)
+        {
+            if (slots == 0 || slots > thread_count())
+                slots = thread_count();
+            slots = std::max<size_t>(std::min(slots, (count + grain - 1) / grain), 1);
+
+            std::atomic<size_t> next_index(0);
+            auto work = [&](const size_t &slot) -> void
+            {
+                try
+                {
+                    for (size_t first; (first = next_index.fetch_add(grain)) < count;)
+                        task(first, std::min(first + grain, count), slot);
+                }
+                catch (...)
+                {
+                    next_index = count; // stop handing out chunks
+                    throw;
+                }
+            };
+            TaskGroup group(*this);
+            for (size_t slot = 1; slot < slots; ++slot)
+                group.run([&work, slot]() -> void
+                          { work(slot); });
+            try
+            {
+                work(0);
+            }
+            catch (...)
+            {
+                try
+                {
+                    group.wait();
+                }
+                catch (...)
+                {
+                }
+                throw;
+            }
+            group.wait();
+        }
+
+    private:
+        size_t own_slot() const noexcept { return current == this ? current_slot : 0; }
+        void start()
+        {
+            for (size_t slot = 1; slot < deques.size(); ++slot)
+            {
+                workers.emplace_back(&TaskScheduler::work, this, slot);
+#ifdef __linux__
+                if (pinned)
+                {
+                    cpu_set_t cores;
+                    CPU_ZERO(&cores);
+                    CPU_SET(slot % std::max(std::thread::hardware_concurrency(), 1u), &cores);
+                    pthread_setaffinity_np(workers.back().native_handle(), sizeof(cores), &cores);
+                }
+#endif
+            }
+        }
+        void submit(std::function<void()> &&task)
+        {
+            std::call_once(started, &TaskScheduler::start, this);
+            Deque &deque = *deques[own_slot()];
+            {
+                std::lock_guard<std::mutex> lock(deque.lock);
+                deque.tasks.push_back(std::move(task));
+            }
+            queued.fetch_add(1);
+            {
+                std::lock_guard<std::mutex> lock(sleep_lock); // a worker between its check and its wait
+            }
+            wake.notify_one();
+        }
+        bool take(const size_t &slot, const bool &own, std::function<void()> &task)
+        {
+            Deque &deque = *deques[slot];
+            std::lock_guard<std::mutex> lock(deque.lock);
+            if (deque.tasks.empty())
+                return false;
+            if (own)
+                task = std::move(deque.tasks.back()), deque.tasks.pop_back();
+            else
+                task = std::move(deque.tasks.front()), deque.tasks.pop_front();
+            queued.fetch_sub(1);
+            return true;
+        }
+        // sleeps with the workers until done() holds or there is a task to help with
+        template <typename Done>
+        void sleep_until(const Done &done)
+        {
+            std::unique_lock<std::mutex> lock(sleep_lock);
+            wake.wait(lock, [this, &done]() -> bool
+                      { return done() || queued.load() != 0; });
+        }
+        void notify_waiters()
+        {
+            {
+                std::lock_guard<std::mutex> lock(sleep_lock); // a waiter between its check and its wait
+            }
+            wake.notify_all();
+        }
+        // runs one task, the newest of its own or else the oldest of someone else's
+        bool run_one()
+        {
+            if (queued.load() == 0)
+                return false;
+            size_t self = own_slot();
+            std::function<void()> task;
+            bool found = take(self, true, task);
+            for (size_t i = 1; !found && i < deques.size(); ++i)
+                found = take((self + i) % deques.size(), false, task);
+            if (found)
+                task();
+            return found;
+        }
+        void work(const size_t &slot)
+        {
+            current = this, current_slot = slot;
+            while (!stopping.load())
+                if (!run_one())
+                {
+                    std::unique_lock<std::mutex> lock(sleep_lock);
+                    wake.wait(lock, [this]() -> bool
+                              { return stopping.load() || queued.load() != 0; });
+                }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,248 @@
+#include <fstream>
+#include <iostream>
+#include <queue>
+#include <stack>
+#include <random>
+
+#include "BoxStack.hpp"
+#include "BoxQueue.hpp"
+#include "BoxBinaryHeap.hpp"
+#include "Chronometer.hpp"
+#include "Lattice.hpp"
+
+// LLVM C++ Style Guide Ruler 100 -----------------------------------------------------------------|
+template <typename Body>
+double time_us(_2Ls::Chronometer &X, Body body)
+{
+    X.set_hi_res_start();
+    body();
+    X.set_hi_res_end();
+    return X.get_us();
+}
+
+std::vector<Coordinate> walkable_positions(const std::string &world, const Lattice &L)
+{
+    int x_size, y_size, z_size;
+    std::ifstream(world) >> x_size >> y_size >> z_size;
+    std::vector<Coordinate> positions;
+    for (int x = 0; x < x_size; ++x)
+        for (int y = 0; y < y_size; ++y)
+            for (int z = 0; z < z_size; ++z)
+                try
+                {
+                    positions.push_back(L.travel(Coordinate(x, y, z), Lattice::Route()));
+                }
+                catch (const InvalidSource &)
+                {
+                }
+    return positions;
+}
+
+int main()
+{
+    std::ostream &log = std::cout;
+    _2Ls::Chronometer X;
+
+    const size_t n = 1 << 20, rounds = 16;
+    std::vector<size_t> keys(n);
+    std::mt19937_64 rng(2024);
+    for (size_t &key : keys)
+        key = rng();
+    size_t sink = 0;
+
+    auto std_stack = [&]
+    {
+        for (size_t r = 0; r < rounds; ++r)
+        {
+            std::stack<size_t> s;
+            for (size_t key : keys)
+                s.push(key);
+            while (!s.empty())
+                sink += s.top(), s.pop();
+        }
+    };
+    auto box_stack = [&]
+    {
+        _2Ls::BoxStack<size_t, false> s(n);
+        for (size_t r = 0; r < rounds; ++r)
+        {
+            for (size_t key : keys)
+                s.push(key);
+            while (!s.empty())
+                sink += s.extract();
+        }
+    };
+    log << "stack: std::stack " << time_us(X, std_stack) << " us, "
+        << "_2Ls::BoxStack " << time_us(X, box_stack) << " us\n";
+
+    auto std_queue = [&]
+    {
+        for (size_t r = 0; r < rounds; ++r)
+        {
+            std::queue<size_t> q;
+            for (size_t key : keys)
+                q.push(key);
+            while (!q.empty())
+                sink += q.front(), q.pop();
+        }
+    };
+    auto box_queue = [&]
+    {
+        _2Ls::BoxQueue<size_t, false> q(n);
+        for (size_t r = 0; r < rounds; ++r)
+        {
+            q.clear();
+            for (size_t key : keys)
+                q.push(key);
+            while (!q.empty())
+                sink += q.extract();
+        }
+    };
+    log << "queue: std::queue " << time_us(X, std_queue) << " us, "
+        << "_2Ls::BoxQueue " << time_us(X, box_queue) << " us\n";
+
+    auto std_heap = [&]
+    {
+        for (size_t r = 0; r < rounds / 4; ++r)
+        {
+            std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> h;
+            for (size_t key : keys)
+                h.push(key);
+            while (!h.empty())
+                sink += h.top(), h.pop();
+        }
+    };
+    auto box_heap = [&]
+    {
+        _2Ls::BoxBinaryHeap<size_t, std::less<size_t>, false> h(n);
+        for (size_t r = 0; r < rounds / 4; ++r)
+        {
+            for (size_t key : keys)
+                h.push(key);
+            while (!h.empty())
+                sink += h.extract();
+        }
+    };
+    log << "heap: std::priority_queue " << time_us(X, std_heap) << " us, "
+        << "_2Ls::BoxBinaryHeap " << time_us(X, box_heap) << " us\n";
+
+    // batch search throughput on a shared lattice
+    const std::string world = "worlds/sandwich.vox";
+    Lattice L(world);
+    L.condense();
+    std::vector<Coordinate> positions = walkable_positions(world, L);
+    const size_t queries = 4096;
+    std::vector<TripPlan> trip_plans(queries);
+    for (TripPlan &trip_plan : trip_plans)
+        trip_plan = TripPlan(positions[rng() % positions.size()], positions[rng() % positions.size()]);
+    std::vector<Lattice::SearchStatus> statuses(queries);
+    std::vector<Lattice::Route> routes(queries);
+
+    auto one_by_one = [&]
+    {
+        for (size_t i = 0; i < queries; ++i)
+            statuses[i] = L.try_search(trip_plans[i], Lattice::BFS, routes[i]);
+    };
+    log << "search: try_search loop " << time_us(X, one_by_one) << " us";
+    for (size_t threads = 1; threads <= std::max(1u, std::thread::hardware_concurrency()); threads *= 2)
+    {
+        auto batch = [&]
+        { L.search_batch(trip_plans.data(), queries, Lattice::BFS, statuses.data(), routes.data(), threads); };
+        log << ", search_batch x" << threads << " " << time_us(X, batch) << " us";
+    }
+    log << "\n";
+    for (const Lattice::Route &route : routes)
+        sink += route.size();
+
+    // the same queries from a handful of hot sources, answered from their cached BFS trees
+    for (size_t i = 0; i < queries; ++i)
+        trip_plans[i].source = trip_plans[i % 4].source;
+    Lattice cold(world);
+    cold.condense();
+    cold.set_source_tree_budget(0); // every tree is evicted as soon as it is built
+    auto cold_sources = [&]
+    {
+        for (size_t i = 0; i < queries; ++i)
+            statuses[i] = cold.try_search(trip_plans[i], Lattice::BFS, routes[i]);
+    };
+    auto hot_sources = [&]
+    {
+        for (size_t i = 0; i < queries; ++i)
+            statuses[i] = L.try_search(trip_plans[i], Lattice::BFS, routes[i]);
+    };
+    log << "hot sources: uncached bfs " << time_us(X, cold_sources) << " us, "
+        << "source tree bfs " << time_us(X, hot_sources) << " us\n";
+    for (const Lattice::Route &route : routes)
+        sink += route.size();
+
+    // patrol loops: a few dozen trips repeated over and over, with and without the route cache
+    for (size_t i = 0; i < queries; ++i)
+        trip_plans[i] = trip_plans[i % 32];
+    auto repeated = [&]
+    {
+        for (size_t i = 0; i < queries; ++i)
+            statuses[i] = L.try_search(trip_plans[i], Lattice::A_STAR, routes[i]);
+    };
+    log << "repeated trips: uncached a* " << time_us(X, repeated) << " us";
+    L.set_route_cache_budget(1 << 20);
+    log << ", route cache a* " << time_us(X, repeated) << " us";
+    Lattice::RouteCacheStats stats = L.route_cache_stats();
+    log << " (" << stats.hits << " hits, " << stats.misses << " misses)\n";
+    L.set_route_cache_budget(0);
+
+    // single query latency with the two sides of a bidirectional search on one thread or two
+    auto bidirectional = [&](const Lattice::SearchMode &search_mode)
+    {
+        return [&, search_mode]
+        {
+            for (size_t i = 0; i < 256; ++i)
+                statuses[i] = L.try_search(trip_plans[rng() % queries], search_mode, routes[i]);
+        };
+    };
+    log << "bidirectional a*: alternating " << time_us(X, bidirectional(Lattice::BIDIRECTIONAL_A_STAR)) << " us, "
+        << "parallel " << time_us(X, bidirectional(Lattice::PARALLEL_BIDIRECTIONAL_A_STAR)) << " us\n";
+
+    // AUTO on the profile guess, then on the modes calibrate_auto_mode measured
+    for (size_t i = 0; i < queries; ++i)
+        trip_plans[i] = TripPlan(positions[rng() % positions.size()], positions[rng() % positions.size()]);
+    auto automatic = [&]
+    {
+        for (size_t i = 0; i < 256; ++i)
+            statuses[i] = L.try_search(trip_plans[i], Lattice::AUTO, routes[i]);
+    };
+    log << "auto: profiled " << time_us(X, automatic) << " us";
+    log << ", calibration " << time_us(X, [&]
+                                      { L.calibrate_auto_mode(); })
+        << " us";
+    log << ", calibrated " << time_us(X, automatic) << " us\n";
+
+    // long a* queries against hash-distributed a* on every thread of the lattice's pool
+    for (const char *hda_world : {"worlds/bastion.vox", "worlds/protein.vox"})
+    {
+        Lattice H(hda_world);
+        H.condense();
+        std::vector<Coordinate> walkable = walkable_positions(hda_world, H);
+        std::vector<TripPlan> long_trips;
+        while (long_trips.size() < 64)
+        {
+            TripPlan trip_plan(walkable[rng() % walkable.size()], walkable[rng() % walkable.size()]);
+            if (H.reachable(trip_plan))
+                long_trips.push_back(trip_plan);
+        }
+        auto run = [&](const Lattice::SearchMode &search_mode)
+        {
+            return [&, search_mode]
+            {
+                for (size_t i = 0; i < long_trips.size(); ++i)
+                    statuses[i] = H.try_search(long_trips[i], search_mode, routes[i]);
+            };
+        };
+        log << hda_world << ": a* " << time_us(X, run(Lattice::A_STAR)) << " us, "
+            << "hda* x" << H.thread_count() << " "
+            << time_us(X, run(Lattice::HASH_DISTRIBUTED_A_STAR)) << " us\n";
+    }
+
+    log << "checksum " << sink << "\n";
+    return EXIT_SUCCESS;
+}
+// LLVM C++ Style Guide Ruler 100 -----------------------------------------------------------------|
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <random>
 
 #include "BoxStack.hpp"
 #include "BoxQueue.hpp"
@@ -6,13 +7,138 @@
 #include "Chronometer.hpp"
 #include "Coordinate.hpp"
 #include "Lattice.hpp"
+#include "PackedRoute.hpp"
 #include "TripPlan.hpp"
 
+// entries of the indexed heap tests: key is the dense id, cost the priority
+struct Entry
+{
+    uint32_t key;
+    int cost;
+};
+struct EntryKey
+{
+    size_t operator()(const Entry &entry) const noexcept { return entry.key; }
+};
+struct EntryLess
+{
+    bool operator()(const Entry &a, const Entry &b) const noexcept { return a.cost < b.cost; }
+};
+// reaches the last generation stamps without four billion clears
+struct StampedHeap : _2Ls::BoxIndexedBinaryHeap<Entry, EntryKey, EntryLess>
+{
+    using BoxIndexedBinaryHeap::BoxIndexedBinaryHeap;
+    void age_to(const uint32_t &generation) noexcept { _generation = generation; }
+    uint32_t generation() const noexcept { return _generation; }
+};
+
 // LLVM C++ Style Guide Ruler 100 -----------------------------------------------------------------|
 int main()
 {
     std::ostream &log = std::cout;
     _2Ls::Chronometer X;
+    bool passed = true;
+    auto check = [&](const bool &condition, const std::string &name) -> void
+    {
+        if (!condition)
+            log << name << " bad\n", passed = false;
+    };
+
+    {
+        // the ring wraps after two extracts, then grows while wrapped
+        _2Ls::BoxQueue<int> queue(4);
+        for (int i = 1; i <= 3; ++i)
+            queue.push(i);
+        queue.extract(), queue.extract();
+        for (int i = 4; i <= 6; ++i)
+            queue.push(i);
+        const _2Ls::BoxQueue<int> &view = queue;
+        std::vector<int> walked(queue.begin(), queue.end()), const_walked(view.begin(), view.end()),
+            c_walked(view.cbegin(), view.cend());
+        check(queue.max_size() == 4 && walked == std::vector<int>{3, 4, 5, 6} && const_walked == walked &&
+                  c_walked == walked && view[0] == 3 && view.back() == 6,
+              "BoxQueue wrapped iteration");
+        queue.push(7);
+        walked.assign(view.begin(), view.end());
+        check(queue.max_size() == 8 && walked == std::vector<int>{3, 4, 5, 6, 7} && queue.front() == 3,
+              "BoxQueue growth across the wrap");
+        std::vector<int> extracted;
+        while (!queue.empty())
+            extracted.push_back(queue.extract());
+        check(extracted == walked, "BoxQueue extract order");
+    }
+
+    {
+        std::mt19937 rng(3);
+        std::vector<int> values(200);
+        for (int &value : values)
+            value = rng() % 50;
+        _2Ls::BoxBinaryHeap<int> heap(values.size());
+        for (const int &value : values)
+            heap.push(value);
+        std::vector<int> extracted;
+        while (!heap.empty())
+            extracted.push_back(heap.extract());
+        std::sort(values.begin(), values.end());
+        check(extracted == values, "BoxBinaryHeap extract order");
+        _2Ls::BoxBinaryHeap<int, std::greater<int>> max_heap = {4, 9, 1, 7};
+        check(max_heap.extract() == 9 && max_heap.extract() == 7 && max_heap.front() == 4,
+              "BoxBinaryHeap initializer list");
+        bool threw = false;
+        try
+        {
+            _2Ls::BoxBinaryHeap<int> full(1);
+            full.push(1), full.push(2);
+        }
+        catch (const std::overflow_error &)
+        {
+            threw = true;
+        }
+        check(threw, "BoxBinaryHeap overflow");
+    }
+
+    {
+        StampedHeap heap(16, 16);
+        for (uint32_t key = 0; key < 10; ++key)
+            heap.push(Entry{key, int(100 - key)});
+        heap.decrease_key(Entry{3, 1});
+        heap.decrease_key(Entry{7, 0});
+        heap.erase(5);
+        check(heap.contains(3) && !heap.contains(5) && heap.get(3).cost == 1 && heap.front().key == 7,
+              "BoxIndexedBinaryHeap decrease_key");
+        std::vector<uint32_t> order;
+        while (!heap.empty())
+            order.push_back(heap.extract().key);
+        check(order == std::vector<uint32_t>{7, 3, 9, 8, 6, 4, 2, 1, 0}, "BoxIndexedBinaryHeap extract order");
+        heap.push(Entry{2, 5});
+        bool duplicate = false, increase = false;
+        try
+        {
+            heap.push(Entry{2, 4});
+        }
+        catch (const std::invalid_argument &)
+        {
+            duplicate = true;
+        }
+        try
+        {
+            heap.decrease_key(Entry{2, 6});
+        }
+        catch (const std::invalid_argument &)
+        {
+            increase = true;
+        }
+        check(duplicate && increase, "BoxIndexedBinaryHeap checks");
+        heap.age_to(UINT32_MAX);
+        heap.push(Entry{4, 1});
+        heap.clear(); // the stamp wraps and every position is refilled
+        bool forgotten = heap.generation() == 1 && heap.empty();
+        for (uint32_t key = 0; key < 16; ++key)
+            forgotten &= !heap.contains(key);
+        heap.push(Entry{4, 3}), heap.push(Entry{2, 2});
+        check(forgotten && heap.contains(4) && heap.extract().key == 2 && heap.extract().key == 4,
+              "BoxIndexedBinaryHeap stamp wrap");
+    }
 
     std::string world_name;
     // log << "enter world name: ";
@@ -42,7 +168,7 @@ int main()
 
     char i = Lattice::DFS;
     Lattice::SearchMode mode = static_cast<Lattice::SearchMode>(i);
-    for (; i <= Lattice::BIDIRECTIONAL_NEGATIVE_A_STAR; mode = static_cast<Lattice::SearchMode>(++i))
+    for (; i <= Lattice::HASH_DISTRIBUTED_A_STAR; mode = static_cast<Lattice::SearchMode>(++i))
     {
         // X.set_hi_res_start();
         bool valid = L.verify(mode);
@@ -54,6 +180,969 @@ int main()
             log << int(i) << "bad\n";
     }
 
+    {
+        PackedRoute packed("nnnseeewwwwsn");
+        check(packed.to_string() == "nnnseeewwwwsn", "PackedRoute round trip");
+        PackedRoute::Run runs[8];
+        size_t run_count = packed.run_length_encode(runs, 8);
+        check(run_count == 6 && runs[0].move == 'n' && runs[0].count == 3 && runs[3].count == 4,
+              "PackedRoute run length encode");
+        check(packed.run_length_encode(runs, 2) == 6, "PackedRoute run length count");
+        PackedRoute decoded;
+        decoded.run_length_decode(runs, packed.run_length_encode(runs, 8));
+        check(decoded.to_string() == packed.to_string(), "PackedRoute run length decode");
+        packed += packed;
+        check(packed.to_string() == "nnnseeewwwwsnnnnseeewwwwsn", "PackedRoute self append");
+        PackedRoute long_route(std::string(100, 'e'));
+        long_route += long_route;
+        check(long_route.to_string() == std::string(200, 'e'), "PackedRoute self append growth");
+
+        uint64_t buffer[2] = {};
+        PackedRoute on_buffer(64, buffer);
+        on_buffer = PackedRoute("nnee");
+        check(on_buffer.data() == buffer && buffer[0] == 0xa0 && on_buffer.to_string() == "nnee",
+              "PackedRoute move assignment keeps the caller buffer");
+        const PackedRoute west(std::string(40, 'w'));
+        on_buffer = west;
+        check(on_buffer.data() == buffer && buffer[0] == ~uint64_t(0) && on_buffer.size() == 40,
+              "PackedRoute copy into the caller buffer");
+        bool threw = false;
+        try
+        {
+            on_buffer = long_route;
+        }
+        catch (const std::length_error &)
+        {
+            threw = true;
+        }
+        check(threw && on_buffer.data() == buffer && on_buffer.size() == 40, "PackedRoute caller buffer full");
+    }
+
+    // the public queries against bfs, on junk and on a, where few nodes share a component
+    for (const std::string &name : {std::string("junk"), std::string("a")})
+    {
+        Lattice W("worlds/" + name + ".vox");
+        W.condense();
+        std::vector<Coordinate> positions = W.region_positions(std::vector<bool>(W.node_count(), true));
+        size_t n = positions.size();
+        std::vector<size_t> bfs_distances(n * n);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+            {
+                Lattice::Route route;
+                bool found = W.try_search(TripPlan(positions[i], positions[j]), Lattice::BFS, route) == Lattice::FOUND;
+                bfs_distances[i * n + j] = found ? route.size() : Lattice::unreachable;
+            }
+        // agrees with bfs on the pair i, j given what a query returned
+        auto agrees = [&](const size_t &i, const size_t &j, const Lattice::SearchStatus &status,
+                          const Lattice::Route &route) -> bool
+        {
+            if (bfs_distances[i * n + j] == Lattice::unreachable)
+                return status == Lattice::UNTRAVERSABLE;
+            return status == Lattice::FOUND && route.size() == bfs_distances[i * n + j] &&
+                   W.travel(positions[i], route) == positions[j];
+        };
+
+        bool all_agree = true;
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+            {
+                PackedRoute packed;
+                Lattice::SearchStatus status = W.try_search(TripPlan(positions[i], positions[j]), Lattice::BFS, packed);
+                all_agree &= agrees(i, j, status, packed.to_string()) &&
+                             W.travel(positions[i], packed) == W.travel(positions[i], packed.to_string());
+            }
+        check(all_agree, name + " packed routes");
+
+        std::vector<size_t> distances(n * n);
+        std::vector<Lattice::SearchStatus> matrix_statuses(n * n);
+        W.distance_matrix(positions.data(), n, positions.data(), n, matrix_statuses.data(), distances.data(), 2);
+        all_agree = distances == bfs_distances;
+        for (size_t k = 0; k < n * n; ++k)
+            all_agree &= matrix_statuses[k] ==
+                         (bfs_distances[k] == Lattice::unreachable ? Lattice::UNTRAVERSABLE : Lattice::FOUND);
+        check(all_agree, name + " distance_matrix");
+        all_agree = true;
+        for (size_t i = 0; i < n; ++i)
+        {
+            std::vector<Lattice::SearchStatus> statuses(n);
+            std::vector<Lattice::Route> routes(n);
+            W.routes_from(positions[i], positions.data(), n, statuses.data(), routes.data());
+            for (size_t j = 0; j < n; ++j)
+                all_agree &= agrees(i, j, statuses[j], routes[j]);
+        }
+        check(all_agree, name + " routes_from");
+
+        // every third node is a target; BFS must reach the nearest, the other modes any of them
+        std::vector<Coordinate> targets;
+        for (size_t j = 0; j < n; j += 3)
+            targets.push_back(positions[j]);
+        for (const Lattice::SearchMode &mode : {Lattice::BFS, Lattice::A_STAR, Lattice::BIDIRECTIONAL_BFS,
+                                                Lattice::BIDIRECTIONAL_A_STAR})
+        {
+            all_agree = true;
+            for (size_t i = 0; i < n; ++i)
+            {
+                size_t nearest_distance = Lattice::unreachable, nearest = targets.size();
+                for (size_t j = 0; j < n; j += 3)
+                    nearest_distance = std::min(nearest_distance, bfs_distances[i * n + j]);
+                Lattice::Route route;
+                Lattice::SearchStatus status = W.try_search_nearest(positions[i], targets.data(), targets.size(),
+                                                                    mode, nearest, route);
+                if (nearest_distance == Lattice::unreachable)
+                    all_agree &= status == Lattice::UNTRAVERSABLE;
+                else
+                    all_agree &= status == Lattice::FOUND && nearest < targets.size() &&
+                                 W.travel(positions[i], route) == targets[nearest] &&
+                                 (mode != Lattice::BFS || route.size() == nearest_distance);
+            }
+            check(all_agree, name + " try_search_nearest " + std::to_string(mode));
+        }
+
+        all_agree = true;
+        for (size_t j = 0; j < n; ++j)
+        {
+            std::shared_ptr<const Lattice::FlowField> field = W.build_flow_field(positions[j]);
+            for (size_t i = 0; i < n; ++i)
+            {
+                Lattice::Route route;
+                all_agree &= W.flow_distance(*field, positions[i]) == bfs_distances[i * n + j] &&
+                             agrees(i, j, W.try_follow_flow_field(*field, positions[i], route), route);
+            }
+        }
+        check(all_agree, name + " flow fields");
+        W.set_flow_field_budget(1); // every field is evicted as soon as it is built
+        all_agree = true;
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+            {
+                PackedRoute packed;
+                Lattice::SearchStatus status = W.try_flow_search(TripPlan(positions[i], positions[j]), packed);
+                all_agree &= agrees(i, j, status, packed.to_string());
+            }
+        check(all_agree, name + " try_flow_search");
+
+        // a fresh lattice answers the first queries of a source with bfs itself and later ones from
+        // the source's tree, which must retrace the very same routes
+        {
+            Lattice T("worlds/" + name + ".vox");
+            T.condense();
+            std::vector<Lattice::Route> first_routes(n * n);
+            all_agree = true;
+            for (size_t pass = 0; pass < 3; ++pass)
+                for (size_t i = 0; i < n; ++i)
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        Lattice::Route route;
+                        Lattice::SearchStatus status = T.try_search(TripPlan(positions[i], positions[j]),
+                                                                    Lattice::BFS, route);
+                        all_agree &= agrees(i, j, status, route);
+                        if (pass == 0)
+                            first_routes[i * n + j] = route;
+                        else
+                            all_agree &= route == first_routes[i * n + j];
+                    }
+            check(all_agree, name + " source trees");
+            T.set_source_tree_budget(0);
+            all_agree = true;
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                {
+                    Lattice::Route route;
+                    Lattice::SearchStatus status = T.try_search(TripPlan(positions[i], positions[j]),
+                                                                Lattice::BFS, route);
+                    all_agree &= agrees(i, j, status, route);
+                }
+            check(all_agree, name + " source trees evicted");
+
+            // threads heating the same sources at once; the one that makes a source hot builds
+            // its tree while the rest run bfs
+            Lattice H("worlds/" + name + ".vox");
+            H.set_thread_count(4);
+            std::vector<TripPlan> batch;
+            for (size_t round = 0; round < 16; ++round)
+                for (size_t j = 0; j < n; ++j)
+                    batch.push_back(TripPlan(positions[round % 2], positions[j]));
+            std::vector<Lattice::SearchStatus> statuses(batch.size());
+            std::vector<Lattice::Route> routes(batch.size());
+            H.search_batch(batch.data(), batch.size(), Lattice::BFS, statuses.data(), routes.data(), 0);
+            all_agree = true;
+            for (size_t k = 0; k < batch.size(); ++k)
+                all_agree &= agrees(k / n % 2, k % n, statuses[k], routes[k]);
+            check(all_agree, name + " source trees built concurrently");
+        }
+
+        // cached answers must be the answers, whether served, evicted or recomputed
+        {
+            Lattice T("worlds/" + name + ".vox");
+            T.condense();
+            T.set_route_cache_budget(1 << 20);
+            std::vector<Lattice::Route> first_routes(n * n), first_super_routes(n * n);
+            all_agree = true;
+            for (size_t pass = 0; pass < 2; ++pass)
+                for (size_t i = 0; i < n; ++i)
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        TripPlan trip_plan(positions[i], positions[j]);
+                        Lattice::Route route, super_route;
+                        all_agree &= agrees(i, j, T.try_search(trip_plan, Lattice::BFS, route), route);
+                        Lattice::SearchStatus status = T.try_super_search(trip_plan, Lattice::BFS, Lattice::BFS,
+                                                                          super_route);
+                        if (bfs_distances[i * n + j] == Lattice::unreachable)
+                            all_agree &= status == Lattice::UNTRAVERSABLE;
+                        else
+                            all_agree &= status == Lattice::FOUND &&
+                                         T.travel(positions[i], super_route) == positions[j];
+                        if (pass == 0)
+                            first_routes[i * n + j] = route, first_super_routes[i * n + j] = super_route;
+                        else
+                            all_agree &= route == first_routes[i * n + j] &&
+                                         super_route == first_super_routes[i * n + j];
+                    }
+            // a super search that stays in one component is the plain search, and shares its entry
+            size_t shared = 0;
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    shared += T.reachable(TripPlan(positions[i], positions[j])) &&
+                              T.reachable(TripPlan(positions[j], positions[i]));
+            Lattice::RouteCacheStats stats = T.route_cache_stats();
+            check(all_agree && stats.hits == 2 * n * n + shared && stats.misses == 2 * n * n - shared &&
+                      stats.evictions == 0,
+                  name + " route cache");
+            T.set_route_cache_budget(256);
+            all_agree = true;
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                {
+                    Lattice::Route route;
+                    Lattice::SearchStatus status = T.try_search(TripPlan(positions[i], positions[j]),
+                                                                Lattice::BFS, route);
+                    all_agree &= agrees(i, j, status, route);
+                }
+            check(all_agree && T.route_cache_stats().evictions != 0, name + " route cache evictions");
+        }
+
+        // distance and reachable, on W and on a copy of the world that is never condensed
+        {
+            Lattice U("worlds/" + name + ".vox");
+            for (const Lattice *lattice : {&W, &U})
+            {
+                all_agree = true;
+                for (size_t i = 0; i < n; ++i)
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        TripPlan trip_plan(positions[i], positions[j]);
+                        size_t expected = bfs_distances[i * n + j];
+                        size_t guessed = lattice->distance(trip_plan, Lattice::AUTO);
+                        all_agree &= lattice->distance(trip_plan, Lattice::BFS) == expected &&
+                                     lattice->reachable(trip_plan) == (expected != Lattice::unreachable) &&
+                                     (guessed == Lattice::unreachable) == (expected == Lattice::unreachable) &&
+                                     (guessed == Lattice::unreachable || guessed >= expected);
+                    }
+                check(all_agree, name + (lattice == &W ? " distance" : " distance uncondensed"));
+            }
+        }
+
+        W.set_thread_count(2); // two threads even on a single core
+        all_agree = true;
+        for (const size_t &threads : {size_t(1), size_t(2)})
+            for (size_t i = 0; i < n; ++i)
+            {
+                for (const size_t &k : {size_t(0), size_t(1), size_t(3)})
+                {
+                    std::vector<bool> region = W.reachable_within(positions[i], k, threads);
+                    for (size_t j = 0; j < n; ++j)
+                        all_agree &= region[W.node_id(positions[j])] == (bfs_distances[i * n + j] <= k);
+                }
+                std::vector<bool> region = W.reachable_region(positions[i], threads);
+                for (size_t j = 0; j < n; ++j)
+                    all_agree &= region[W.node_id(positions[j])] == (bfs_distances[i * n + j] != Lattice::unreachable);
+            }
+        check(all_agree, name + " reachable regions");
+
+        // whichever mode wins, the race must answer like bfs, exactly so when bfs races alone
+        all_agree = true;
+        std::vector<Lattice::SearchMode> racers = {Lattice::BFS, Lattice::A_STAR, Lattice::DFS,
+                                                   Lattice::HASH_DISTRIBUTED_A_STAR};
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+            {
+                TripPlan trip_plan(positions[i], positions[j]);
+                Lattice::SearchMode winner;
+                Lattice::Route route;
+                all_agree &= agrees(i, j, W.try_search_race(trip_plan, {Lattice::BFS}, winner, route), route) &&
+                             winner == Lattice::BFS;
+                Lattice::SearchStatus status = W.try_search_race(trip_plan, racers, winner, route);
+                if (bfs_distances[i * n + j] == Lattice::unreachable)
+                    all_agree &= status == Lattice::UNTRAVERSABLE;
+                else
+                    all_agree &= status == Lattice::FOUND && W.travel(positions[i], route) == positions[j] &&
+                                 (winner != Lattice::BFS || route.size() == bfs_distances[i * n + j]);
+                all_agree &= std::find(racers.begin(), racers.end(), winner) != racers.end();
+            }
+        {
+            Lattice::SearchMode winner;
+            Lattice::Route route;
+            TripPlan trip_plan(positions[0], positions[n - 1]);
+            all_agree &= W.try_search_race(trip_plan, {}, winner, route) == Lattice::INVALID_SEARCH_MODE &&
+                         W.try_search_race(trip_plan, {Lattice::BFS, Lattice::AUTO}, winner, route) ==
+                             Lattice::INVALID_SEARCH_MODE &&
+                         winner == Lattice::AUTO;
+        }
+        check(all_agree, name + " try_search_race");
+        all_agree = true;
+        for (size_t i = 0; i < n; ++i)
+            for (size_t j = 0; j < n; ++j)
+            {
+                uint64_t buffer[4] = {};
+                PackedRoute on_buffer(4 * PackedRoute::moves_per_word, buffer);
+                Lattice::SearchMode winner;
+                Lattice::SearchStatus status = W.try_search_race(TripPlan(positions[i], positions[j]),
+                                                                 {Lattice::BFS}, winner, on_buffer);
+                std::string written; // read back from the caller's array, not through on_buffer
+                for (size_t k = 0; k < on_buffer.size(); ++k)
+                    written += PackedRoute::decode(buffer[k / PackedRoute::moves_per_word] >>
+                                                   (k % PackedRoute::moves_per_word * 2));
+                all_agree &= on_buffer.data() == buffer && agrees(i, j, status, written);
+            }
+        check(all_agree, name + " try_search_race into a caller buffer");
+
+        // a batch of every pair plus invalid ends, with a workspace per thread, on 1 to 4 threads
+        {
+            Coordinate outside(-1, -1, -1);
+            std::vector<TripPlan> batch;
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                    batch.push_back(TripPlan(positions[i], positions[j]));
+            batch.push_back(TripPlan(outside, positions[0]));
+            batch.push_back(TripPlan(positions[0], outside));
+            W.set_thread_count(4);
+            all_agree = true;
+            for (const size_t &threads : {size_t(1), size_t(2), size_t(0)})
+            {
+                std::vector<Lattice::SearchStatus> statuses(batch.size());
+                std::vector<Lattice::Route> routes(batch.size());
+                W.search_batch(batch.data(), batch.size(), Lattice::BFS, statuses.data(), routes.data(), threads);
+                for (size_t i = 0; i < n; ++i)
+                    for (size_t j = 0; j < n; ++j)
+                        all_agree &= agrees(i, j, statuses[i * n + j], routes[i * n + j]);
+                all_agree &= statuses[n * n] == Lattice::INVALID_SOURCE &&
+                             statuses[n * n + 1] == Lattice::INVALID_TARGET;
+                std::vector<PackedRoute> packed(batch.size());
+                W.search_batch(batch.data(), batch.size(), Lattice::A_STAR, statuses.data(), packed.data(), threads);
+                for (size_t i = 0; i < n; ++i)
+                    for (size_t j = 0; j < n; ++j)
+                        all_agree &= (statuses[i * n + j] == Lattice::FOUND) ==
+                                         (bfs_distances[i * n + j] != Lattice::unreachable) &&
+                                     W.travel(positions[i], packed[i * n + j]) ==
+                                         (statuses[i * n + j] == Lattice::FOUND ? positions[j] : positions[i]);
+            }
+            check(all_agree, name + " search_batch");
+        }
+
+        // AUTO before condensation, after it and after calibration may pick any mode that answers
+        // like bfs, and calibration only keeps modes that do
+        {
+            Lattice U("worlds/" + name + ".vox");
+            auto auto_agrees = [&](const Lattice &lattice) -> bool
+            {
+                bool all = true;
+                for (size_t i = 0; i < n; ++i)
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        TripPlan trip_plan(positions[i], positions[j]);
+                        Lattice::Route route;
+                        Lattice::SearchStatus status = lattice.try_search(trip_plan, Lattice::AUTO, route);
+                        if (bfs_distances[i * n + j] == Lattice::unreachable)
+                            all &= status == Lattice::UNTRAVERSABLE;
+                        else
+                            all &= status == Lattice::FOUND && lattice.travel(positions[i], route) == positions[j];
+                    }
+                return all;
+            };
+            check(auto_agrees(U), name + " AUTO uncondensed");
+            U.condense();
+            check(auto_agrees(U), name + " AUTO");
+            U.calibrate_auto_mode(8);
+            all_agree = auto_agrees(U);
+            for (size_t i = 0; i < n; ++i)
+                for (size_t j = 0; j < n; ++j)
+                {
+                    Lattice::SearchMode mode = U.auto_mode(TripPlan(positions[i], positions[j]));
+                    all_agree &= mode == Lattice::BFS || mode == Lattice::DFS || mode == Lattice::GBFS ||
+                                 mode == Lattice::A_STAR;
+                }
+            check(all_agree, name + " AUTO calibrated");
+        }
+    }
+
+    // compact state retraces through 2-bit moves and the ambiguous_last side table where falls
+    // land several nodes on one with the same move; it must find routes as long as full state's
+    for (const std::string &name : {std::string("dungeon"), std::string("bastion")})
+    {
+        Lattice full("worlds/" + name + ".vox"), compact("worlds/" + name + ".vox");
+        full.set_thread_count(1), compact.set_thread_count(1); // the parallel modes then run in order
+        compact.set_compact_state(true);
+        std::vector<Coordinate> positions = full.region_positions(std::vector<bool>(full.node_count(), true));
+        std::mt19937 rng(7);
+        bool all_agree = true;
+        for (size_t sample = 0; sample < 40; ++sample)
+        {
+            TripPlan trip_plan(positions[rng() % positions.size()], positions[rng() % positions.size()]);
+            for (char i = Lattice::DFS; i <= Lattice::HASH_DISTRIBUTED_A_STAR; ++i)
+            {
+                Lattice::Route full_route, compact_route;
+                Lattice::SearchMode mode = static_cast<Lattice::SearchMode>(i);
+                Lattice::SearchStatus status = full.try_search(trip_plan, mode, full_route);
+                all_agree &= compact.try_search(trip_plan, mode, compact_route) == status &&
+                             compact_route.size() == full_route.size();
+                if (status == Lattice::FOUND)
+                    all_agree &= compact.travel(trip_plan.source, compact_route) == trip_plan.target;
+            }
+        }
+        check(all_agree, name + " compact state");
+    }
+
+    // the queries again on dungeon, whose 2372 nodes fall into 43 components, at sampled pairs
+    {
+        Lattice D("worlds/dungeon.vox");
+        D.condense();
+        std::vector<Coordinate> positions = D.region_positions(std::vector<bool>(D.node_count(), true));
+        std::mt19937 rng(11);
+        std::vector<Coordinate> sources, targets;
+        for (size_t sample = 0; sample < 24; ++sample)
+        {
+            sources.push_back(positions[rng() % positions.size()]);
+            targets.push_back(positions[rng() % positions.size()]);
+        }
+        // bfs distance from sources[i] to targets[j]
+        auto bfs_distance = [&](const size_t &i, const size_t &j) -> size_t
+        {
+            Lattice::Route route;
+            return D.try_search(TripPlan(sources[i], targets[j]), Lattice::BFS, route) == Lattice::FOUND
+                       ? route.size()
+                       : Lattice::unreachable;
+        };
+        const Coordinate nowhere(-1000, -1000, -1000);
+
+        // each target twice, which must not change the nearest, and more targets than h scans exactly
+        std::vector<Coordinate> doubled(targets);
+        doubled.insert(doubled.end(), targets.rbegin(), targets.rend());
+        for (const Lattice::SearchMode &mode : {Lattice::BFS, Lattice::A_STAR, Lattice::BIDIRECTIONAL_BFS,
+                                                Lattice::BIDIRECTIONAL_A_STAR})
+        {
+            bool all_agree = true;
+            for (size_t i = 0; i < sources.size(); ++i)
+            {
+                size_t nearest_distance = Lattice::unreachable, nearest = doubled.size();
+                for (size_t j = 0; j < targets.size(); ++j)
+                    nearest_distance = std::min(nearest_distance, bfs_distance(i, j));
+                Lattice::Route route;
+                Lattice::SearchStatus status = D.try_search_nearest(sources[i], doubled.data(), doubled.size(), mode,
+                                                                    nearest, route);
+                if (nearest_distance == Lattice::unreachable)
+                    all_agree &= status == Lattice::UNTRAVERSABLE;
+                else
+                    all_agree &= status == Lattice::FOUND && nearest < targets.size() &&
+                                 D.travel(sources[i], route) == doubled[nearest] &&
+                                 (mode != Lattice::BFS || route.size() == nearest_distance);
+            }
+            size_t nearest = 0;
+            Lattice::Route route;
+            std::vector<Coordinate> lost(targets);
+            lost.push_back(nowhere);
+            all_agree &= D.try_search_nearest(nowhere, targets.data(), targets.size(), mode, nearest, route) ==
+                             Lattice::INVALID_SOURCE &&
+                         D.try_search_nearest(sources[0], lost.data(), lost.size(), mode, nearest, route) ==
+                             Lattice::INVALID_TARGET;
+            check(all_agree, "dungeon try_search_nearest " + std::to_string(mode));
+        }
+
+        bool all_agree = true;
+        for (size_t j = 0; j < targets.size(); ++j)
+        {
+            std::shared_ptr<const Lattice::FlowField> field = D.build_flow_field(targets[j]);
+            for (size_t i = 0; i < sources.size(); ++i)
+            {
+                Lattice::Route route;
+                Lattice::SearchStatus status = D.try_follow_flow_field(*field, sources[i], route);
+                size_t distance = bfs_distance(i, j);
+                all_agree &= D.flow_distance(*field, sources[i]) == distance &&
+                             status == (distance == Lattice::unreachable ? Lattice::UNTRAVERSABLE
+                                                                         : Lattice::FOUND) &&
+                             route.size() == (status == Lattice::FOUND ? distance : 0) &&
+                             (status != Lattice::FOUND || D.travel(sources[i], route) == targets[j]);
+            }
+        }
+        Lattice J("worlds/junk.vox"); // a field built on another lattice leads nowhere here
+        std::shared_ptr<const Lattice::FlowField> foreign =
+            J.build_flow_field(J.region_positions(std::vector<bool>(J.node_count(), true)).front());
+        Lattice::Route route;
+        all_agree &= D.try_follow_flow_field(*foreign, sources[0], route) == Lattice::UNTRAVERSABLE &&
+                     route.empty() &&
+                     D.try_flow_search(TripPlan(nowhere, targets[0]), route) == Lattice::INVALID_SOURCE &&
+                     D.try_flow_search(TripPlan(sources[0], nowhere), route) == Lattice::INVALID_TARGET;
+        check(all_agree, "dungeon flow fields");
+
+        // a dungeon field takes about 10 KB, so three fit and the least recently used goes first
+        D.set_flow_field_budget(35 << 10);
+        std::shared_ptr<const Lattice::FlowField> first = D.build_flow_field(targets[0]),
+                                                  second = D.build_flow_field(targets[1]);
+        D.build_flow_field(targets[2]);
+        all_agree = D.build_flow_field(targets[0]) == first; // second is now the least recent
+        D.build_flow_field(targets[3]);
+        all_agree &= D.build_flow_field(targets[0]) == first && D.build_flow_field(targets[1]) != second &&
+                     D.flow_distance(*second, sources[0]) == bfs_distance(0, 1); // still valid for its holder
+        check(all_agree, "dungeon flow field eviction");
+
+        // one workspace per thread runs every query, so each must start from a cleared bitset
+        std::vector<TripPlan> batch;
+        for (size_t i = 0; i < sources.size(); ++i)
+            for (size_t j = 0; j < targets.size(); ++j)
+                batch.emplace_back(sources[i], targets[j]);
+        batch.emplace_back(nowhere, targets[0]), batch.emplace_back(sources[0], nowhere);
+        all_agree = true;
+        for (const size_t &threads : {size_t(1), size_t(0)})
+        {
+            std::vector<Lattice::SearchStatus> statuses(batch.size());
+            std::vector<PackedRoute> packed(batch.size());
+            D.search_batch(batch.data(), batch.size(), Lattice::DIRECTION_OPTIMIZING_BFS, statuses.data(),
+                           packed.data(), threads);
+            for (size_t i = 0; i < sources.size(); ++i)
+                for (size_t j = 0; j < targets.size(); ++j)
+                {
+                    size_t k = i * targets.size() + j, distance = bfs_distance(i, j);
+                    all_agree &= distance == Lattice::unreachable
+                                     ? statuses[k] == Lattice::UNTRAVERSABLE
+                                     : statuses[k] == Lattice::FOUND && packed[k].size() == distance &&
+                                           D.travel(sources[i], packed[k]) == targets[j];
+                }
+            all_agree &= statuses[batch.size() - 2] == Lattice::INVALID_SOURCE &&
+                         statuses[batch.size() - 1] == Lattice::INVALID_TARGET;
+        }
+        check(all_agree, "dungeon direction-optimizing bfs batch");
+
+        // a bad endpoint spoils only its own row or column
+        std::vector<Coordinate> matrix_sources(sources), matrix_targets(targets);
+        matrix_sources.insert(matrix_sources.begin() + 1, nowhere), matrix_targets.push_back(nowhere);
+        size_t rows = matrix_sources.size(), columns = matrix_targets.size();
+        std::vector<Lattice::SearchStatus> statuses(rows * columns);
+        std::vector<size_t> distances(rows * columns);
+        D.distance_matrix(matrix_sources.data(), rows, matrix_targets.data(), columns, statuses.data(),
+                          distances.data(), 0);
+        all_agree = true;
+        for (size_t r = 0; r < rows; ++r)
+            for (size_t j = 0; j < columns; ++j)
+            {
+                Lattice::SearchStatus status = statuses[r * columns + j];
+                size_t distance = distances[r * columns + j];
+                if (r == 1)
+                    all_agree &= status == Lattice::INVALID_SOURCE && distance == Lattice::unreachable;
+                else if (j == columns - 1)
+                    all_agree &= status == Lattice::INVALID_TARGET && distance == Lattice::unreachable;
+                else
+                {
+                    size_t expected = bfs_distance(r - (r > 1), j);
+                    all_agree &= distance == expected &&
+                                 status == (expected == Lattice::unreachable ? Lattice::UNTRAVERSABLE
+                                                                             : Lattice::FOUND);
+                }
+            }
+        check(all_agree, "dungeon distance_matrix");
+
+        // AUTO's routes are cached under the mode it resolved to, so a recalibrated AUTO never gets
+        // the route of a mode it no longer picks, and condense() drops everything cached before it
+        {
+            Lattice C("worlds/dungeon.vox");
+            C.set_route_cache_budget(1 << 20);
+            for (size_t i = 0; i < sources.size(); ++i)
+            {
+                Lattice::Route route;
+                C.try_super_search(TripPlan(sources[i], targets[i]), Lattice::BFS, Lattice::BFS, route);
+            }
+            all_agree = C.route_cache_stats().bytes != 0;
+            C.condense();
+            all_agree &= C.route_cache_stats().bytes == 0;
+            for (size_t calibrated = 0; calibrated < 2; ++calibrated)
+            {
+                if (calibrated)
+                    C.calibrate_auto_mode();
+                for (size_t i = 0; i < sources.size(); ++i)
+                {
+                    TripPlan trip_plan(sources[i], targets[i]);
+                    Lattice::Route route, resolved_route;
+                    Lattice::SearchStatus status = C.try_search(trip_plan, Lattice::AUTO, route);
+                    size_t distance = bfs_distance(i, i), hits = C.route_cache_stats().hits;
+                    all_agree &= status == (distance == Lattice::unreachable ? Lattice::UNTRAVERSABLE
+                                                                             : Lattice::FOUND);
+                    if (status != Lattice::FOUND)
+                        continue;
+                    all_agree &= route.size() == distance &&
+                                 C.try_search(trip_plan, C.auto_mode(trip_plan), resolved_route) == Lattice::FOUND &&
+                                 resolved_route == route && C.route_cache_stats().hits == hits + 1;
+                }
+            }
+            check(all_agree, "dungeon route cache keyed on the resolved mode");
+        }
+
+        // HDA* on more partitions than cores; every run's route is as long as bfs's
+        {
+            Lattice H("worlds/dungeon.vox");
+            H.set_thread_count(4);
+            all_agree = true;
+            for (size_t i = 0; i < sources.size(); ++i)
+                for (size_t j = 0; j < targets.size(); j += 3)
+                {
+                    TripPlan trip_plan(sources[i], targets[j]);
+                    size_t distance = bfs_distance(i, j);
+                    for (size_t run = 0; run < 2; ++run)
+                    {
+                        PackedRoute route;
+                        Lattice::SearchStatus status = H.try_search(trip_plan, Lattice::HASH_DISTRIBUTED_A_STAR, route);
+                        all_agree &= distance == Lattice::unreachable
+                                         ? status == Lattice::UNTRAVERSABLE
+                                         : status == Lattice::FOUND && route.size() == distance &&
+                                               H.travel(sources[i], route) == targets[j];
+                    }
+                }
+            check(all_agree, "dungeon hash-distributed A*");
+        }
+
+        // AUTO super searches, through the condensation or not as the profile decides: dungeon has
+        // most nodes in one component, so it runs plain searches, while bastion's are all small
+        all_agree = true;
+        {
+            Lattice B("worlds/bastion.vox");
+            B.condense();
+            std::vector<Coordinate> bastion = B.region_positions(std::vector<bool>(B.node_count(), true));
+            for (size_t sample = 0; sample < 12; ++sample)
+            {
+                TripPlan trip_plan(bastion[rng() % bastion.size()], bastion[rng() % bastion.size()]);
+                Lattice::Route route, bfs_route;
+                Lattice::SearchStatus status = B.try_super_search(trip_plan, Lattice::AUTO, Lattice::AUTO, route);
+                all_agree &= status == B.try_search(trip_plan, Lattice::BFS, bfs_route) &&
+                             (status != Lattice::FOUND || (B.travel(trip_plan.source, route) == trip_plan.target &&
+                                                           route.size() >= bfs_route.size()));
+            }
+        }
+        for (size_t i = 0; i < sources.size(); ++i)
+            for (size_t j = 0; j < targets.size(); j += 4)
+            {
+                Lattice::Route route;
+                Lattice::SearchStatus status = D.try_super_search(TripPlan(sources[i], targets[j]), Lattice::AUTO,
+                                                                  Lattice::AUTO, route);
+                all_agree &= bfs_distance(i, j) == Lattice::unreachable
+                                 ? status == Lattice::UNTRAVERSABLE
+                                 : status == Lattice::FOUND && D.travel(sources[i], route) == targets[j] &&
+                                       route.size() >= bfs_distance(i, j);
+            }
+        check(all_agree, "dungeon AUTO super search");
+
+        // packed routes match string ones move for move, and one written into a caller's buffer
+        // must fit: the buffer is used as it is, and a route one move too long for it throws
+        all_agree = true;
+        for (const Lattice::SearchMode &mode : {Lattice::DFS, Lattice::BFS, Lattice::A_STAR,
+                                                Lattice::BIDIRECTIONAL_BFS})
+            for (size_t i = 0; i < sources.size(); ++i)
+            {
+                TripPlan trip_plan(sources[i], targets[i]);
+                Lattice::Route route;
+                PackedRoute packed;
+                Lattice::SearchStatus status = D.try_search(trip_plan, mode, route);
+                all_agree &= D.try_search(trip_plan, mode, packed) == status && packed.to_string() == route;
+                if (status != Lattice::FOUND || route.empty())
+                    continue;
+                std::vector<uint64_t> buffer((route.size() + 31) / 32);
+                PackedRoute fitted(route.size(), buffer.data()), short_by_one(route.size() - 1, buffer.data());
+                bool threw = false;
+                try
+                {
+                    D.try_search(trip_plan, mode, short_by_one);
+                }
+                catch (const std::length_error &)
+                {
+                    threw = true;
+                }
+                all_agree &= threw && D.try_search(trip_plan, mode, fitted) == Lattice::FOUND &&
+                             fitted.data() == buffer.data() && fitted.to_string() == route;
+            }
+        PackedRoute packed;
+        all_agree &= D.try_search(TripPlan(nowhere, targets[0]), Lattice::BFS, packed) == Lattice::INVALID_SOURCE &&
+                     D.try_search(TripPlan(sources[0], nowhere), Lattice::BFS, packed) == Lattice::INVALID_TARGET;
+        check(all_agree, "dungeon packed routes");
+
+        // a source turns hot after a few queries and is answered from its tree from then on; the
+        // routes must be bfs's move for move, with room for every tree or for none
+        {
+            Lattice cold("worlds/dungeon.vox");
+            cold.set_source_tree_budget(0);
+            for (const size_t &budget : {size_t(64 << 20), size_t(64)})
+            {
+                Lattice S("worlds/dungeon.vox");
+                S.set_source_tree_budget(budget);
+                all_agree = true;
+                for (size_t pass = 0; pass < 3; ++pass)
+                    for (size_t i = 0; i < 4; ++i)
+                        for (size_t j = 0; j < targets.size(); ++j)
+                        {
+                            TripPlan trip_plan(sources[i], targets[j]);
+                            Lattice::Route route, bfs_route;
+                            all_agree &= S.try_search(trip_plan, Lattice::BFS, route) ==
+                                             cold.try_search(trip_plan, Lattice::BFS, bfs_route) &&
+                                         route == bfs_route;
+                        }
+                Lattice::Route route;
+                all_agree &= S.try_search(TripPlan(nowhere, targets[0]), Lattice::BFS, route) ==
+                                 Lattice::INVALID_SOURCE &&
+                             S.try_search(TripPlan(sources[0], nowhere), Lattice::BFS, route) ==
+                                 Lattice::INVALID_TARGET;
+                check(all_agree, "dungeon source trees with a budget of " + std::to_string(budget));
+            }
+        }
+
+        // the route cache shared by a batch on several threads: every pair once is a miss or, if
+        // another thread got there first, a hit, a second batch hits throughout, and a budget too
+        // small for the batch evicts without changing any answer
+        {
+            Lattice R("worlds/dungeon.vox"), uncached("worlds/dungeon.vox");
+            R.set_thread_count(4), R.set_route_cache_budget(1 << 20);
+            std::vector<TripPlan> pairs;
+            for (size_t i = 0; i < sources.size(); ++i)
+                for (size_t j = 0; j < targets.size(); ++j)
+                    pairs.emplace_back(sources[i], targets[j]);
+            std::vector<Lattice::Route> expected(pairs.size());
+            std::vector<Lattice::SearchStatus> expected_statuses(pairs.size());
+            uncached.search_batch(pairs.data(), pairs.size(), Lattice::A_STAR, expected_statuses.data(),
+                                  expected.data(), 1);
+            pairs.emplace_back(nowhere, targets[0]), pairs.emplace_back(sources[0], nowhere); // never cached
+            size_t queries = pairs.size() - 2;
+            all_agree = true;
+            for (size_t pass = 0; pass < 3; ++pass)
+            {
+                if (pass == 2)
+                    R.set_route_cache_budget(4 << 10);
+                std::vector<Lattice::SearchStatus> statuses(pairs.size());
+                std::vector<Lattice::Route> routes(pairs.size());
+                R.search_batch(pairs.data(), pairs.size(), Lattice::A_STAR, statuses.data(), routes.data(), 0);
+                for (size_t k = 0; k < queries; ++k)
+                    all_agree &= statuses[k] == expected_statuses[k] && routes[k] == expected[k];
+                all_agree &= statuses[queries] == Lattice::INVALID_SOURCE &&
+                             statuses[queries + 1] == Lattice::INVALID_TARGET;
+                Lattice::RouteCacheStats stats = R.route_cache_stats();
+                if (pass == 0)
+                    all_agree &= stats.hits + stats.misses == queries;
+                else if (pass == 1)
+                    all_agree &= stats.hits + stats.misses == 2 * queries && stats.misses <= queries &&
+                                 stats.hits >= queries && stats.evictions == 0;
+                else
+                    all_agree &= stats.evictions != 0 && stats.bytes <= 4 << 10;
+            }
+            check(all_agree, "dungeon route cache shared by a batch");
+        }
+
+        // distance and reachable on dungeon, condensed and not: the condensation answers most
+        // misses without a search, and must agree with the search it skips
+        {
+            Lattice U("worlds/dungeon.vox");
+            for (const Lattice *lattice : {&D, &U})
+            {
+                all_agree = true;
+                for (size_t i = 0; i < sources.size(); ++i)
+                    for (size_t j = 0; j < targets.size(); ++j)
+                    {
+                        TripPlan trip_plan(sources[i], targets[j]);
+                        size_t expected = bfs_distance(i, j), guessed = lattice->distance(trip_plan, Lattice::A_STAR);
+                        all_agree &= lattice->distance(trip_plan, Lattice::BFS) == expected &&
+                                     lattice->reachable(trip_plan) == (expected != Lattice::unreachable) &&
+                                     (guessed == Lattice::unreachable) == (expected == Lattice::unreachable) &&
+                                     (expected == Lattice::unreachable || guessed >= expected);
+                    }
+                size_t thrown = 0;
+                for (const TripPlan &trip_plan : {TripPlan(nowhere, targets[0]), TripPlan(sources[0], nowhere)})
+                {
+                    try
+                    {
+                        lattice->reachable(trip_plan);
+                    }
+                    catch (const InvalidSource &)
+                    {
+                        thrown += trip_plan.source == nowhere;
+                    }
+                    catch (const InvalidTarget &)
+                    {
+                        thrown += trip_plan.target == nowhere;
+                    }
+                }
+                check(all_agree && thrown == 2, std::string("dungeon distance and reachable, ") +
+                                                    (lattice == &D ? "condensed" : "not condensed"));
+            }
+        }
+
+        // a flood k moves deep holds exactly the nodes bfs puts within k, from k = 0 (the source
+        // alone) to no bound at all, on one thread or several
+        {
+            Lattice F("worlds/dungeon.vox");
+            F.set_thread_count(4);
+            all_agree = true;
+            for (size_t i = 0; i < 4; ++i)
+            {
+                std::vector<Lattice::SearchStatus> statuses(positions.size());
+                std::vector<size_t> distances(positions.size());
+                F.distance_matrix(&sources[i], 1, positions.data(), positions.size(), statuses.data(),
+                                  distances.data());
+                for (const size_t &k : {size_t(0), size_t(1), size_t(7), size_t(30), Lattice::unreachable})
+                    for (const size_t &threads : {size_t(1), size_t(4)})
+                    {
+                        std::vector<bool> region = F.reachable_within(sources[i], k, threads);
+                        for (size_t id = 0; id < positions.size(); ++id)
+                            all_agree &= region[id] ==
+                                         (distances[id] != Lattice::unreachable && distances[id] <= k);
+                    }
+            }
+            bool threw = false;
+            try
+            {
+                F.reachable_within(nowhere, 1);
+            }
+            catch (const InvalidSource &)
+            {
+                threw = true;
+            }
+            check(all_agree && threw, "dungeon reachable_within");
+
+            // sandwich's 17948 nodes make levels wide enough to split across threads
+            Lattice W("worlds/sandwich.vox");
+            W.set_thread_count(4);
+            Coordinate middle = W.region_positions(std::vector<bool>(W.node_count(), true))[W.node_count() / 2];
+            all_agree = true;
+            for (const size_t &k : {size_t(16), size_t(64), Lattice::unreachable})
+                all_agree &= W.reachable_within(middle, k, 4) == W.reachable_within(middle, k, 1);
+            check(all_agree, "sandwich reachable_within on several threads");
+        }
+
+        // races on four threads between modes that themselves spread over the scheduler; the
+        // losers are cancelled mid-search, and the winner's route lands in the caller's buffer
+        {
+            Lattice P("worlds/dungeon.vox");
+            P.set_thread_count(4);
+            const std::vector<Lattice::SearchMode> racers = {Lattice::BFS, Lattice::PARALLEL_BIDIRECTIONAL_BFS,
+                                                             Lattice::DIRECTION_OPTIMIZING_BFS,
+                                                             Lattice::HASH_DISTRIBUTED_A_STAR};
+            std::vector<uint64_t> buffer(positions.size() / 32 + 1);
+            all_agree = true;
+            for (size_t i = 0; i < sources.size(); ++i)
+                for (size_t j = 0; j < targets.size(); j += 3)
+                {
+                    Lattice::SearchMode winner = Lattice::AUTO;
+                    PackedRoute route(positions.size(), buffer.data());
+                    Lattice::SearchStatus status = P.try_search_race(TripPlan(sources[i], targets[j]), racers,
+                                                                     winner, route);
+                    size_t distance = bfs_distance(i, j);
+                    all_agree &= std::find(racers.begin(), racers.end(), winner) != racers.end() &&
+                                 route.data() == buffer.data();
+                    all_agree &= distance == Lattice::unreachable
+                                     ? status == Lattice::UNTRAVERSABLE
+                                     : status == Lattice::FOUND && P.travel(sources[i], route) == targets[j] &&
+                                           (winner == Lattice::PARALLEL_BIDIRECTIONAL_BFS ||
+                                            route.size() == distance); // the others are shortest
+                }
+            Lattice::SearchMode winner;
+            Lattice::Route route;
+            all_agree &= P.try_search_race(TripPlan(nowhere, targets[0]), racers, winner, route) ==
+                             Lattice::INVALID_SOURCE &&
+                         P.try_search_race(TripPlan(sources[0], nowhere), racers, winner, route) ==
+                             Lattice::INVALID_TARGET;
+            check(all_agree, "dungeon try_search_race");
+        }
+    }
+
+    // super searches on bastion, whose 12688 nodes fall into 1781 components, with the legs
+    // resolved on several threads by sub modes that search component-local subgraphs (DFS to A*)
+    // and by those that run on the whole lattice (the parallel ones)
+    {
+        Lattice B("worlds/bastion.vox");
+        B.condense();
+        B.set_thread_count(4);
+        std::vector<Coordinate> positions = B.region_positions(std::vector<bool>(B.node_count(), true));
+        std::mt19937 rng(13);
+        std::vector<TripPlan> trip_plans;
+        std::vector<size_t> bfs_lengths;
+        for (size_t reached = 0, missed = 0; reached < 8 || missed < 2;) // most pairs here are apart
+        {
+            TripPlan trip_plan(positions[rng() % positions.size()], positions[rng() % positions.size()]);
+            Lattice::Route route;
+            bool found = B.try_search(trip_plan, Lattice::BFS, route) == Lattice::FOUND;
+            size_t &count = found ? reached : missed;
+            if (count == (found ? 8 : 2))
+                continue;
+            ++count;
+            trip_plans.push_back(trip_plan);
+            bfs_lengths.push_back(found ? route.size() : Lattice::unreachable);
+        }
+        const Lattice::SearchMode sub_modes[] = {Lattice::DFS, Lattice::BFS, Lattice::GBFS, Lattice::A_STAR,
+                                                 Lattice::PARALLEL_BIDIRECTIONAL_BFS,
+                                                 Lattice::PARALLEL_BIDIRECTIONAL_A_STAR,
+                                                 Lattice::DIRECTION_OPTIMIZING_BFS,
+                                                 Lattice::HASH_DISTRIBUTED_A_STAR};
+        // a super route reaches the target exactly when bfs does, and is never shorter
+        auto super_agrees = [&](const size_t &k, const Lattice::SearchStatus &status,
+                                const Lattice::Route &route) -> bool
+        {
+            if (bfs_lengths[k] == Lattice::unreachable)
+                return status == Lattice::UNTRAVERSABLE;
+            return status == Lattice::FOUND && route.size() >= bfs_lengths[k] &&
+                   B.travel(trip_plans[k].source, route) == trip_plans[k].target;
+        };
+        for (const Lattice::SearchMode &sub_mode : sub_modes)
+        {
+            bool all_agree = true;
+            for (size_t k = 0; k < trip_plans.size(); ++k)
+            {
+                // The second call takes every leg from the portal memo, so a route across components
+                // comes back unchanged. Within one component it is searched again, and the parallel
+                // sub modes may then find another route of the same length.
+                Lattice::Route route, memoized;
+                Lattice::SearchStatus status = B.try_super_search(trip_plans[k], Lattice::BFS, sub_mode, route);
+                bool crosses = !B.reachable(TripPlan(trip_plans[k].target, trip_plans[k].source));
+                all_agree &= super_agrees(k, status, route) &&
+                             B.try_super_search(trip_plans[k], Lattice::BFS, sub_mode, memoized) == status &&
+                             memoized.size() == route.size() && (!crosses || memoized == route);
+            }
+            check(all_agree, "bastion super search " + std::to_string(sub_mode));
+        }
+
+        // legs searched on a component's locals retrace through 2-bit moves in compact state, and
+        // must come out as long as they do in full state
+        Lattice C("worlds/bastion.vox");
+        C.condense();
+        C.set_compact_state(true);
+        bool all_agree = true;
+        for (const Lattice::SearchMode &sub_mode : {Lattice::DFS, Lattice::BFS, Lattice::GBFS, Lattice::A_STAR})
+            for (size_t k = 0; k < trip_plans.size(); ++k)
+            {
+                Lattice::Route full_route, compact_route;
+                Lattice::SearchStatus status = B.try_super_search(trip_plans[k], Lattice::BFS, sub_mode, full_route);
+                all_agree &= C.try_super_search(trip_plans[k], Lattice::BFS, sub_mode, compact_route) == status &&
+                             compact_route.size() == full_route.size() && super_agrees(k, status, compact_route);
+            }
+        check(all_agree, "bastion compact super search");
+
+        // one super arc per pair of components, with every portal between them on its list: each
+        // super mode, forward, reverse or bidirectional, must still get wherever bfs gets
+        for (const Lattice::SearchMode &super_mode : {Lattice::DFS, Lattice::BFS, Lattice::GBFS, Lattice::A_STAR,
+                                                      Lattice::REVERSE_BFS, Lattice::BIDIRECTIONAL_BFS,
+                                                      Lattice::BIDIRECTIONAL_A_STAR})
+        {
+            all_agree = true;
+            for (size_t k = 0; k < trip_plans.size(); ++k)
+            {
+                Lattice::Route route;
+                all_agree &= super_agrees(k, B.try_super_search(trip_plans[k], super_mode, Lattice::BFS, route), route);
+            }
+            check(all_agree, "bastion super mode " + std::to_string(super_mode));
+        }
+    }
+
     /*
     TripPlan trip_plan(Coordinate(7, 0, 9), Coordinate(3, 0, 1)); // a
     Lattice::Route route;
@@ -72,6 +1161,8 @@ int main()
         << "Search time: " << X.get_us() << " microseconds\n\n";
     */
 
+    if (!passed)
+        return EXIT_FAILURE;
     log << "SUCCESS" << std::endl;
     return EXIT_SUCCESS;
 }
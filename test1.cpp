@@ -42,7 +42,7 @@ int main()
 
     char i = Lattice::DFS;
     Lattice::SearchMode mode = static_cast<Lattice::SearchMode>(i);
-    for (; i <= Lattice::BIDIRECTIONAL_NEGATIVE_A_STAR; mode = static_cast<Lattice::SearchMode>(++i))
+    for (; i <= Lattice::HASH_DISTRIBUTED_A_STAR; mode = static_cast<Lattice::SearchMode>(++i))
     {
         // X.set_hi_res_start();
         bool valid = L.verify(mode);